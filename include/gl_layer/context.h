@@ -1,6 +1,8 @@
 #ifndef GL_VALIDATION_LAYER_H_
 #define GL_VALIDATION_LAYER_H_
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -24,14 +26,49 @@ typedef struct ContextGLFunctions
 int gl_layer_init(unsigned int gl_version_major, unsigned int gl_version_minor, const ContextGLFunctions* gl_functions);
 
 /**
- * @brief Terminate the OpenGL Validation Layer.
+ * @brief Terminate the OpenGL Validation Layer. The context created by gl_layer_init() is destroyed, threads that made it current go back
+ *        to the default context, which is the one of the next gl_layer_init(). It must not be in use on another thread at the same time.
  */
 void gl_layer_terminate();
 
+typedef struct GLLayerContext GLLayerContext;
+/**
+ * @brief Creates a layer context for an additional OpenGL context, for example a shared context used to upload resources on a worker
+ *        thread. The context created by gl_layer_init() is used on every thread that did not make another one current. New contexts
+ *        start with the output, deduplication and rule settings of that context, settings functions always apply to the context current
+ *        on the calling thread.
+ * @param gl_version_major OpenGL context major version.
+ * @param gl_version_minor OpenGL context minor version.
+ * @param gl_functions Structure with OpenGL function pointers the layer needs to call to work.
+ * @param share_context Context whose shaders and programs are shared with the new one, like the share context passed when creating the
+ *        OpenGL context. Pass nullptr for a context with its own objects.
+ * @return The new context.
+ */
+GLLayerContext* gl_layer_create_context(unsigned int gl_version_major, unsigned int gl_version_minor,
+                                        const ContextGLFunctions* gl_functions, GLLayerContext* share_context);
+
+/**
+ * @brief Destroys a context created with gl_layer_create_context(). Threads that made it current go back to the context created by
+ *        gl_layer_init(). It must not be in use on another thread at the same time.
+ */
+void gl_layer_destroy_context(GLLayerContext* context);
+
+/**
+ * @brief Makes a context current on the calling thread, call this whenever you make the matching OpenGL context current. Validation on this
+ *        thread then uses that context. Pass nullptr to go back to the context created by gl_layer_init().
+ */
+void gl_layer_make_current(GLLayerContext* context);
+
+/**
+ * @brief Returns the context validation uses on the calling thread, to pass as the share context to gl_layer_create_context().
+ */
+GLLayerContext* gl_layer_get_current_context();
+
 /**
- * @brief This function will be used to perform validation. To enable validation, this must be called before every OpenGL call you make.
- *        When using the GLAD loader, this can be done by simply calling glad_set_pre_callback(&gl_layer_callback). If you are using a
- *        different loader, you will need to register this callback some other way.
+ * @brief This function will be used to perform validation. To enable validation, this must be called after every OpenGL call you make,
+ *        validating queries like glGetShaderiv reads the values the driver returned. When using the GLAD loader, this can be done by
+ *        simply calling glad_set_post_callback(&gl_layer_callback). If you are using a different loader, you will need to register this
+ *        callback some other way.
  * @param name Name of the OpenGL function being called.
  * @param func_ptr Pointer to the OpenGL function being called.
  * @param num_args Amount of arguments.
@@ -39,6 +76,135 @@ void gl_layer_terminate();
  */
 void gl_layer_callback(const char* name, void* func_ptr, int num_args, ...);
 
+typedef void* (*GLLayerLoadProc)(const char* name);
+/**
+ * @brief Wraps an OpenGL function loader so validation is only done for the functions the layer checks. Pass the returned function to your
+ *        loader instead of load_proc, for example gladLoadGLLoader((GLADloadproc)gl_layer_load((GLLayerLoadProc)glfwGetProcAddress)).
+ *        Validated functions are returned as thin wrappers that call the driver and then validate the call, every other function is returned
+ *        as-is and costs nothing extra. Do not also register gl_layer_callback() when using this.
+ *        The wrappers call one set of driver functions for the whole process, the ones resolved by the last load: loading again, for example
+ *        for a second context, redirects every wrapper handed out before. Only share the loader between contexts whose function pointers
+ *        are the same. Where they differ, as with some WGL contexts, use the typed hooks or gl_layer_callback() instead.
+ * @param load_proc The loader function you would otherwise pass to your OpenGL loader.
+ * @return A loader function that hands out the validating wrappers.
+ */
+GLLayerLoadProc gl_layer_load(GLLayerLoadProc load_proc);
+
+/**
+ * @brief Typed validation hooks, one per validated OpenGL function. These are an alternative to gl_layer_callback() for loaders
+ *        that can call the layer directly: they take the same arguments as the OpenGL function they are named after, and skip both
+ *        the function name lookup and the varargs unpacking. Like gl_layer_callback(), they must be called after the OpenGL call.
+ */
+void gl_layer_on_glCompileShader(unsigned int shader);
+void gl_layer_on_glGetShaderiv(unsigned int shader, unsigned int pname, int* params);
+void gl_layer_on_glAttachShader(unsigned int program, unsigned int shader);
+void gl_layer_on_glGetProgramiv(unsigned int program, unsigned int pname, int* params);
+void gl_layer_on_glLinkProgram(unsigned int program);
+void gl_layer_on_glUseProgram(unsigned int program);
+void gl_layer_on_glDeleteProgram(unsigned int program);
+void gl_layer_on_glDeleteShader(unsigned int shader);
+void gl_layer_on_glEnable(unsigned int cap);
+void gl_layer_on_glDisable(unsigned int cap);
+void gl_layer_on_glActiveTexture(unsigned int texture);
+void gl_layer_on_glBindTexture(unsigned int target, unsigned int texture);
+void gl_layer_on_glDeleteTextures(int n, const unsigned int* textures);
+void gl_layer_on_glBindBuffer(unsigned int target, unsigned int buffer);
+void gl_layer_on_glBindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+void gl_layer_on_glBindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, ptrdiff_t offset, ptrdiff_t size);
+void gl_layer_on_glDeleteBuffers(int n, const unsigned int* buffers);
+void gl_layer_on_glBindVertexArray(unsigned int array);
+void gl_layer_on_glDeleteVertexArrays(int n, const unsigned int* arrays);
+void gl_layer_on_glBlendFunc(unsigned int sfactor, unsigned int dfactor);
+void gl_layer_on_glDepthFunc(unsigned int func);
+void gl_layer_on_glUniform1f(int location, float v0);
+void gl_layer_on_glUniform2f(int location, float v0, float v1);
+void gl_layer_on_glUniform3f(int location, float v0, float v1, float v2);
+void gl_layer_on_glUniform4f(int location, float v0, float v1, float v2, float v3);
+void gl_layer_on_glUniform1i(int location, int v0);
+void gl_layer_on_glUniform2i(int location, int v0, int v1);
+void gl_layer_on_glUniform3i(int location, int v0, int v1, int v2);
+void gl_layer_on_glUniform4i(int location, int v0, int v1, int v2, int v3);
+void gl_layer_on_glUniform1ui(int location, unsigned int v0);
+void gl_layer_on_glUniform2ui(int location, unsigned int v0, unsigned int v1);
+void gl_layer_on_glUniform3ui(int location, unsigned int v0, unsigned int v1, unsigned int v2);
+void gl_layer_on_glUniform4ui(int location, unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3);
+void gl_layer_on_glUniform1fv(int location, int count, const float* value);
+void gl_layer_on_glUniform2fv(int location, int count, const float* value);
+void gl_layer_on_glUniform3fv(int location, int count, const float* value);
+void gl_layer_on_glUniform4fv(int location, int count, const float* value);
+void gl_layer_on_glUniform1iv(int location, int count, const int* value);
+void gl_layer_on_glUniform2iv(int location, int count, const int* value);
+void gl_layer_on_glUniform3iv(int location, int count, const int* value);
+void gl_layer_on_glUniform4iv(int location, int count, const int* value);
+void gl_layer_on_glUniform1uiv(int location, int count, const unsigned int* value);
+void gl_layer_on_glUniform2uiv(int location, int count, const unsigned int* value);
+void gl_layer_on_glUniform3uiv(int location, int count, const unsigned int* value);
+void gl_layer_on_glUniform4uiv(int location, int count, const unsigned int* value);
+void gl_layer_on_glUniformMatrix2fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glUniformMatrix3fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glUniformMatrix4fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glUniformMatrix2x3fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glUniformMatrix3x2fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glUniformMatrix2x4fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glUniformMatrix4x2fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glUniformMatrix3x4fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glUniformMatrix4x3fv(int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glDrawArrays(unsigned int mode, int first, int count);
+void gl_layer_on_glDrawElements(unsigned int mode, int count, unsigned int type, const void* indices);
+void gl_layer_on_glDrawArraysInstanced(unsigned int mode, int first, int count, int instancecount);
+void gl_layer_on_glDrawElementsInstanced(unsigned int mode, int count, unsigned int type, const void* indices, int instancecount);
+void gl_layer_on_glProgramUniform1f(unsigned int program, int location, float v0);
+void gl_layer_on_glProgramUniform2f(unsigned int program, int location, float v0, float v1);
+void gl_layer_on_glProgramUniform3f(unsigned int program, int location, float v0, float v1, float v2);
+void gl_layer_on_glProgramUniform4f(unsigned int program, int location, float v0, float v1, float v2, float v3);
+void gl_layer_on_glProgramUniform1i(unsigned int program, int location, int v0);
+void gl_layer_on_glProgramUniform2i(unsigned int program, int location, int v0, int v1);
+void gl_layer_on_glProgramUniform3i(unsigned int program, int location, int v0, int v1, int v2);
+void gl_layer_on_glProgramUniform4i(unsigned int program, int location, int v0, int v1, int v2, int v3);
+void gl_layer_on_glProgramUniform1ui(unsigned int program, int location, unsigned int v0);
+void gl_layer_on_glProgramUniform2ui(unsigned int program, int location, unsigned int v0, unsigned int v1);
+void gl_layer_on_glProgramUniform3ui(unsigned int program, int location, unsigned int v0, unsigned int v1, unsigned int v2);
+void gl_layer_on_glProgramUniform4ui(unsigned int program, int location, unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3);
+void gl_layer_on_glProgramUniform1fv(unsigned int program, int location, int count, const float* value);
+void gl_layer_on_glProgramUniform2fv(unsigned int program, int location, int count, const float* value);
+void gl_layer_on_glProgramUniform3fv(unsigned int program, int location, int count, const float* value);
+void gl_layer_on_glProgramUniform4fv(unsigned int program, int location, int count, const float* value);
+void gl_layer_on_glProgramUniform1iv(unsigned int program, int location, int count, const int* value);
+void gl_layer_on_glProgramUniform2iv(unsigned int program, int location, int count, const int* value);
+void gl_layer_on_glProgramUniform3iv(unsigned int program, int location, int count, const int* value);
+void gl_layer_on_glProgramUniform4iv(unsigned int program, int location, int count, const int* value);
+void gl_layer_on_glProgramUniform1uiv(unsigned int program, int location, int count, const unsigned int* value);
+void gl_layer_on_glProgramUniform2uiv(unsigned int program, int location, int count, const unsigned int* value);
+void gl_layer_on_glProgramUniform3uiv(unsigned int program, int location, int count, const unsigned int* value);
+void gl_layer_on_glProgramUniform4uiv(unsigned int program, int location, int count, const unsigned int* value);
+void gl_layer_on_glProgramUniformMatrix2fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glProgramUniformMatrix3fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glProgramUniformMatrix4fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glProgramUniformMatrix2x3fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glProgramUniformMatrix3x2fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glProgramUniformMatrix2x4fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glProgramUniformMatrix4x2fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glProgramUniformMatrix3x4fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+void gl_layer_on_glProgramUniformMatrix4x3fv(unsigned int program, int location, int count, unsigned char transpose, const float* value);
+
+typedef struct GLLayerCompileStats
+{
+  unsigned int compiles;         // glCompileShader calls.
+  unsigned int links;            // glLinkProgram calls.
+  unsigned int overlapped;       // Compiles and links started while another one was still in flight.
+  unsigned int in_flight;        // Compiles and links the application has not yet seen finish.
+  unsigned int max_in_flight;    // Highest value in_flight reached.
+  unsigned int completion_polls; // GL_COMPLETION_STATUS_KHR queries.
+}GLLayerCompileStats;
+
+/**
+ * @brief Reports how many shader compiles and program links overlapped. A compile or link is considered in flight from the call that starts it
+ *        until the application sees it finish, by polling GL_COMPLETION_STATUS_KHR or by querying GL_COMPILE_STATUS/GL_LINK_STATUS.
+ * @param stats Structure to write the statistics to.
+ * @return 0 on success, any other value if the layer is not initialized.
+ */
+int gl_layer_get_compile_stats(GLLayerCompileStats* stats);
+
 typedef void (*GLLayerOutputFun)(const char* text, void* user_data);
 /**
  * @brief This function allows the user to set a custom callback for writing validation output.
@@ -48,6 +214,192 @@ typedef void (*GLLayerOutputFun)(const char* text, void* user_data);
  */
 [[maybe_unused]] void gl_layer_set_output_callback(GLLayerOutputFun callback, void* user_data = nullptr);
 
+typedef enum GLLayerSeverity
+{
+  GL_LAYER_SEVERITY_INFO = 0,    // Reports from the layer itself, like summaries.
+  GL_LAYER_SEVERITY_WARNING = 1, // Works, but is fragile or likely a mistake.
+  GL_LAYER_SEVERITY_ERROR = 2    // Invalid use of the API.
+}GLLayerSeverity;
+
+#define GL_LAYER_MAX_MESSAGE_HANDLES 2
+#define GL_LAYER_MAX_MESSAGE_ARGS 8
+
+/**
+ * @brief A validation message as plain data. Consumers can filter, count or store these without ever building the message text,
+ *        use gl_layer_format_message() to get the text when needed. Message ids and entry point ids are stable across versions.
+ */
+typedef struct GLLayerMessage
+{
+  unsigned int id;                                  // What went wrong, see gl_layer_message_id_name().
+  GLLayerSeverity severity;
+  unsigned int entry_point;                         // OpenGL function that caused the message, see gl_layer_entry_point_name().
+  unsigned int handle_count;
+  unsigned int handles[GL_LAYER_MAX_MESSAGE_HANDLES]; // Objects the message is about.
+  unsigned int arg_count;
+  unsigned long long args[GL_LAYER_MAX_MESSAGE_ARGS]; // Raw arguments of the call. Floats and pointers are stored as their bits.
+}GLLayerMessage;
+
+typedef void (*GLLayerMessageFun)(const GLLayerMessage* message, void* user_data);
+/**
+ * @brief Sets a callback that receives every message as a GLLayerMessage record instead of text. While a message callback is set, the
+ *        text output callback is not called and no message text is built. Pass nullptr to go back to text output.
+ * @param callback Callback that is called for each message. The record is only valid for the duration of the call.
+ * @param user_data Pointer to any user data you want passed into the function.
+ */
+void gl_layer_set_message_callback(GLLayerMessageFun callback, void* user_data);
+
+/**
+ * @brief Renders the text for a message record, as it would be passed to the output callback.
+ * @param message The message to format.
+ * @param buffer Buffer to write the null terminated text to, may be nullptr if size is 0.
+ * @param size Size of buffer in bytes.
+ * @return The length of the full text, excluding the null terminator. If this is size or more, the text was truncated.
+ */
+size_t gl_layer_format_message(const GLLayerMessage* message, char* buffer, size_t size);
+
+/**
+ * @brief Returns the name of a message id, or "<unknown>".
+ */
+const char* gl_layer_message_id_name(unsigned int id);
+
+/**
+ * @brief Returns the name of the OpenGL function for an entry point id, or "<unknown>".
+ */
+const char* gl_layer_entry_point_name(unsigned int entry_point);
+
+typedef enum GLLayerDropPolicy
+{
+  GL_LAYER_DROP_NEWEST = 0, // Discard the message that does not fit.
+  GL_LAYER_DROP_OLDEST = 1, // Discard the oldest queued message to make room.
+  GL_LAYER_BLOCK = 2        // Wait until the background thread made room.
+}GLLayerDropPolicy;
+
+/**
+ * @brief Enables or disables asynchronous output. When enabled, message records are copied into a bounded lock-free queue and
+ *        the output or message callback is called from a background thread instead of the thread making the OpenGL call. Message text is
+ *        only built on the background thread. Disabling delivers every queued message before returning.
+ * @param enabled Non-zero to enable asynchronous output, zero to go back to calling the output callback directly.
+ * @param capacity Number of messages the queue can hold, rounded up to a power of two.
+ * @param policy What to do with a message when the queue is full.
+ * @return 0 on success, any other value if the layer is not initialized.
+ */
+int gl_layer_set_async_output(int enabled, unsigned int capacity, GLLayerDropPolicy policy);
+
+/**
+ * @brief Blocks until every message queued for asynchronous output was passed to the output callback.
+ */
+void gl_layer_flush_output();
+
+/**
+ * @brief Returns how many messages were discarded because the asynchronous output queue was full.
+ */
+unsigned long long gl_layer_get_dropped_message_count();
+
+/**
+ * @brief Configures deduplication of repeated messages, which is enabled by default with a one second interval. A message is reported
+ *        the first time it occurs for an object, repeats of the same message for the same object are only counted. Once the summary interval
+ *        passed, one summary line is written per message and object that repeated, by gl_layer_end_frame() or, with asynchronous output, by
+ *        the background thread. Deleting a shader or program writes its summaries and forgets its messages. Changing the settings writes out
+ *        the pending summary first.
+ * @param enabled Non-zero to deduplicate messages, zero to report every occurrence.
+ * @param summary_interval_ms Minimum time between two summaries of suppressed messages, in milliseconds.
+ * @return 0 on success, any other value if the layer is not initialized.
+ */
+int gl_layer_set_message_dedup(int enabled, unsigned int summary_interval_ms);
+
+typedef enum GLLayerRule
+{
+  GL_LAYER_RULE_NONE = 0,
+  GL_LAYER_RULE_SHADER_COMPILE = 1 << 0, // Shaders are compiled, their status checked and successful before they are attached.
+  GL_LAYER_RULE_PROGRAM_LINK = 1 << 1,   // Programs are linked, their status checked and successful before they are used.
+  GL_LAYER_RULE_PROGRAM_BOUND = 1 << 2,  // A program is bound when one is required.
+  GL_LAYER_RULE_REDUNDANT_STATE = 1 << 3, // Programs, bindings, capabilities, blend and depth functions are not set to the value they already
+                                          // have. Reported once per frame, see gl_layer_end_frame().
+  GL_LAYER_RULE_DRAW_STATE = 1 << 4,      // A vertex array is bound and the uniforms of the program were set before drawing.
+  GL_LAYER_RULE_UNIFORM = 1 << 5,         // glUniform and glProgramUniform calls match the type, array size and location of an active uniform.
+                                          // Needs GL_LAYER_RULE_PROGRAM_LINK, programs are not tracked without it.
+  GL_LAYER_RULE_REDUNDANT_UNIFORMS = 1 << 6, // Uniform uploads change the value of the uniform. Keeps a copy of the uniforms of every program,
+                                             // reported once per frame, see gl_layer_end_frame().
+  GL_LAYER_RULE_ALL = 0x7F
+}GLLayerRule;
+
+/**
+ * @brief Selects which categories of checks are run, all of them are enabled by default. The initial mask can also be set with the
+ *        GL_LAYER_RULES environment variable, read by gl_layer_init(): either a number, or a comma separated list of rule names such as
+ *        "shader_compile,program_link", or "all" or "none". An OpenGL function is only looked at when one of the rules it matters for is
+ *        enabled, calls to any other function return right away. Objects are only tracked while their rule is enabled, so the mask is best
+ *        set before any objects are created.
+ * @param mask Combination of GLLayerRule flags.
+ * @return 0 on success, any other value if the layer is not initialized.
+ */
+int gl_layer_set_rule_mask(unsigned int mask);
+
+/**
+ * @brief Returns the enabled GLLayerRule flags, or 0 if the layer is not initialized.
+ */
+unsigned int gl_layer_get_rule_mask();
+
+typedef enum GLLayerSamplingMode
+{
+  GL_LAYER_SAMPLE_ALL = 0,    // Validate every call.
+  GL_LAYER_SAMPLE_CALLS = 1,  // Validate one in every period calls to each OpenGL function.
+  GL_LAYER_SAMPLE_FRAMES = 2  // Validate every call in one in every period frames, see gl_layer_end_frame().
+}GLLayerSamplingMode;
+
+/**
+ * @brief Validates only a fraction of calls, to keep validation on in long running tests at a fraction of the cost. Calls that are not sampled
+ *        still update what the layer knows about objects and bindings, so the sampled ones are checked correctly, but report nothing.
+ *        With GL_LAYER_SAMPLE_CALLS, the first call to each function is always validated.
+ * @param mode Which calls to validate.
+ * @param period Validate one in this many calls or frames. 0 is treated as 1.
+ * @return 0 on success, any other value if the layer is not initialized.
+ */
+int gl_layer_set_sampling(GLLayerSamplingMode mode, unsigned int period);
+
+/**
+ * @brief Marks the end of a frame on the current context, call this right after swapping buffers. While GL_LAYER_RULE_REDUNDANT_STATE is
+ *        enabled, this reports how many calls set state to the value it already had during the frame: one message per program that was
+ *        bound again while bound, and one per other OpenGL function. While GL_LAYER_RULE_REDUNDANT_UNIFORMS is enabled, it also reports
+ *        one message per program that had uniforms uploaded with the values they already had.
+ */
+void gl_layer_end_frame();
+
+typedef struct GLLayerFrameStats
+{
+  unsigned long long frame;                   // Frames ended on the context before this one.
+  unsigned int redundant_program_binds;       // glUseProgram calls with the program that was already bound.
+  unsigned int state_changes;                 // Calls that bind objects or set the tracked state, including glUseProgram.
+  unsigned int redundant_state_changes;       // Of those, calls that set state to the value it already had, and could be left out.
+  unsigned int uniform_uploads;               // glUniform and glProgramUniform calls that uploaded values.
+  unsigned int redundant_uniform_uploads;     // Of those, uploads of the values the uniforms already had.
+  unsigned long long redundant_uniform_bytes; // Bytes uploaded by those.
+}GLLayerFrameStats;
+
+/**
+ * @brief Reports the statistics of the last frame ended with gl_layer_end_frame() on the current context. Redundant state changes are only
+ *        counted while GL_LAYER_RULE_REDUNDANT_STATE is enabled, uniform uploads while GL_LAYER_RULE_REDUNDANT_UNIFORMS is.
+ * @param stats Structure to write the statistics to.
+ * @return 0 on success, any other value if the layer is not initialized.
+ */
+int gl_layer_get_frame_stats(GLLayerFrameStats* stats);
+
+/**
+ * @brief Starts recording every call to an OpenGL function the layer validates on the current context, with its arguments, to see what led up
+ *        to a message. Calls are recorded whether or not a rule needs them, along with the ends of frames. The file is mapped into memory and
+ *        used as a ring buffer, once it is full the oldest calls are overwritten. It holds every call up to the last one even if the process
+ *        crashes. Recording can also be started for the context created by gl_layer_init() by setting the GL_LAYER_TRACE environment variable
+ *        to the path of the file, with a size of 16 MiB. Starting a new trace stops the one recorded so far.
+ * @param path File to record to, it is created or overwritten.
+ * @param size Size of the file in bytes, rounded up to whole blocks of 64 KiB, at least two.
+ * @return 0 on success, any other value if the layer is not initialized or the file could not be created.
+ */
+int gl_layer_start_trace(const char* path, unsigned long long size);
+
+/**
+ * @brief Stops recording calls on the current context, and closes the trace file.
+ */
+void gl_layer_stop_trace();
+
 #ifdef __cplusplus
 };
 #endif
@@ -0,0 +1,60 @@
+#ifndef GL_VALIDATION_LAYER_ASYNC_OUTPUT_H_
+#define GL_VALIDATION_LAYER_ASYNC_OUTPUT_H_
+
+#include <gl_layer/context.h>
+#include <gl_layer/private/message_queue.h>
+#include <gl_layer/private/messages.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace gl_layer {
+
+// Hands validation messages to a background thread, which passes them to the output or message callback. The thread
+// calling into the layer only copies the message record into a lock-free queue, the text is built on the background
+// thread. What happens when the queue is full is decided by the drop policy. If dedup is given, the background thread
+// also writes its summaries once summary_interval passed, even while no more messages are reported.
+class AsyncOutput {
+public:
+    AsyncOutput(std::size_t capacity, GLLayerDropPolicy policy, const MessageSink& sink, MessageDeduplicator* dedup,
+                std::chrono::milliseconds summary_interval);
+    ~AsyncOutput();
+
+    AsyncOutput(const AsyncOutput&) = delete;
+    AsyncOutput& operator=(const AsyncOutput&) = delete;
+
+    void push(const GLLayerMessage& message);
+
+    // Blocks until every message pushed so far was delivered.
+    void flush();
+
+    std::uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    void writer_main();
+
+    MessageQueue<GLLayerMessage> queue;
+    GLLayerDropPolicy policy;
+    MessageSink sink;
+    MessageDeduplicator* dedup;
+    std::chrono::milliseconds summary_interval;
+
+    std::atomic<std::uint64_t> pushed_count{ 0 };
+    std::atomic<std::uint64_t> delivered_count{ 0 };
+    std::atomic<std::uint64_t> dropped_count{ 0 };
+
+    // Only used to put the writer to sleep while the queue is empty, producers never take the mutex.
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::atomic<bool> writer_waiting{ false };
+    std::atomic<bool> stop{ false };
+    std::thread writer;
+};
+
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef GL_VALIDATION_LAYER_BITSET_POOL_H_
+#define GL_VALIDATION_LAYER_BITSET_POOL_H_
+
+#include <gl_layer/private/epoch.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gl_layer {
+
+inline int lowest_set_bit(std::uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#else
+    int index = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Small bitsets of many objects, allocated from shared pages of 64 bit words. An allocation is referred to by the index
+// of its first word, so an object stores 4 bytes instead of owning a heap block. Sizes are rounded up to a power of two
+// words, and ranges are aligned to their size so they never cross a page. Freed ranges are reused by allocations of the
+// same size.
+//
+// Pages never move or go away while the pool exists, so words can be read and written from any thread without a lock.
+// Allocating and freeing lock.
+class BitsetPool : public std::enable_shared_from_this<BitsetPool> {
+public:
+    static constexpr std::size_t page_bits = 12;
+    static constexpr std::size_t page_words = std::size_t{ 1 } << page_bits;
+    static constexpr std::size_t max_pages = 4096;
+    static constexpr std::uint32_t none = ~std::uint32_t{ 0 };
+
+    BitsetPool() : pages(std::make_unique<std::atomic<Page*>[]>(max_pages)) {}
+    BitsetPool(const BitsetPool&) = delete;
+    BitsetPool& operator=(const BitsetPool&) = delete;
+
+    ~BitsetPool() {
+        for (std::size_t i = 0; i < max_pages; ++i) delete pages[i].load(std::memory_order_relaxed);
+    }
+
+    // Returns the first of word_count zeroed words, or none if word_count is larger than a page or the pool is full.
+    std::uint32_t allocate(std::size_t word_count) {
+        if (word_count == 0 || word_count > page_words) return none;
+
+        std::size_t size_class = size_class_of(word_count);
+        std::size_t size = std::size_t{ 1 } << size_class;
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::uint32_t first;
+        if (!free_lists[size_class].empty()) {
+            first = free_lists[size_class].back();
+            free_lists[size_class].pop_back();
+        } else {
+            // The gap up to the next aligned range is split into smaller aligned ranges for later.
+            while (next % size != 0) {
+                std::size_t gap = next & (~next + 1);
+                free_lists[size_class_of(gap)].push_back(static_cast<std::uint32_t>(next));
+                next += gap;
+            }
+
+            std::size_t page = next >> page_bits;
+            if (page >= max_pages) return none;
+            if (!pages[page].load(std::memory_order_relaxed)) {
+                pages[page].store(new Page(), std::memory_order_release);
+                ++page_count;
+            }
+            first = static_cast<std::uint32_t>(next);
+            next += size;
+        }
+
+        std::atomic<std::uint64_t>* range = words(first);
+        for (std::size_t i = 0; i < size; ++i) range[i].store(0, std::memory_order_relaxed);
+        return first;
+    }
+
+    // word_count must be the count the range was allocated with. No thread may use the words anymore.
+    void free(std::uint32_t first, std::size_t word_count) {
+        if (first == none) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        free_lists[size_class_of(word_count)].push_back(first);
+    }
+
+    // Frees the words once every EpochGuard that exists right now has ended, for ranges other threads may still read.
+    void free_deferred(std::uint32_t first, std::size_t word_count) {
+        if (first == none) return;
+
+        struct Pending {
+            std::shared_ptr<BitsetPool> pool;
+            std::uint32_t first;
+            std::size_t word_count;
+        };
+        retire(new Pending{ shared_from_this(), first, word_count }, [](void* p) {
+            auto* pending = static_cast<Pending*>(p);
+            pending->pool->free(pending->first, pending->word_count);
+            delete pending;
+        });
+    }
+
+    std::atomic<std::uint64_t>* words(std::uint32_t first) const {
+        Page* page = pages[first >> page_bits].load(std::memory_order_acquire);
+        return page->words + (first & (page_words - 1));
+    }
+
+    // Bytes allocated for pages, including words that are not in use.
+    std::size_t memory_usage() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return max_pages * sizeof(std::atomic<Page*>) + page_count * sizeof(Page);
+    }
+
+private:
+    struct Page {
+        std::atomic<std::uint64_t> words[page_words];
+    };
+
+    static std::size_t size_class_of(std::size_t word_count) {
+        std::size_t size_class = 0;
+        while ((std::size_t{ 1 } << size_class) < word_count) ++size_class;
+        return size_class;
+    }
+
+    std::unique_ptr<std::atomic<Page*>[]> pages;
+    mutable std::mutex mutex;
+    std::vector<std::uint32_t> free_lists[page_bits + 1];
+    std::size_t next = 0;
+    std::size_t page_count = 0;
+};
+
+}
+
+#endif
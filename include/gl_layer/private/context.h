@@ -3,19 +3,132 @@
 
 #include <gl_layer/context.h>
 #include <gl_layer/private/types.h>
+#include <gl_layer/private/async_output.h>
+#include <gl_layer/private/dispatch_cache.h>
+#include <gl_layer/private/epoch.h>
+#include <gl_layer/private/messages.h>
+#include <gl_layer/private/object_table.h>
+#include <gl_layer/private/state_shadow.h>
+#include <gl_layer/private/trace.h>
 
-#include <unordered_map>
+#include <algorithm>
+#include <string_view>
+#include <chrono>
 #include <cassert>
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace gl_layer {
 
+// Objects shared by all contexts in a share group. State that belongs to one context, like the bound program, stays in
+// the Context.
+class ShareGroup {
+public:
+    ObjectTable<Shader> shaders{};
+    ObjectTable<Program> programs{};
+    // Bitsets of the uniforms each program wrote.
+    std::shared_ptr<BitsetPool> uniform_bitsets = std::make_shared<BitsetPool>();
+
+    std::mutex stats_mutex;
+    GLLayerCompileStats compile_stats{};
+
+    // Once a second context joins, the objects may be used from several threads. A group is only ever shared by
+    // contexts created with a share context, and OpenGL requires those to be created before the share context is used
+    // from another thread.
+    void add_context() {
+        if (++context_count > 1) {
+            shaders.set_concurrent();
+            programs.set_concurrent();
+        }
+    }
+
+    void remove_context() { --context_count; }
+
+    // Keeps the objects looked up until the end of the scope alive, while other contexts may change them.
+    EpochGuard read() const { return EpochGuard(programs.is_concurrent()); }
+
+private:
+    std::atomic<int> context_count{ 0 };
+};
+
+// Parses a rule mask like GL_LAYER_RULES: a number, or a comma separated list of rule names. Unknown names are ignored.
+std::uint32_t parse_rule_mask(std::string_view text);
+
 class Context {
 public:
-    explicit Context(Version version, const ContextGLFunctions* gl_functions);
+    // Creates a context in share_group, or in a new share group of its own if share_group is null.
+    Context(Version version, const ContextGLFunctions* gl_functions, std::shared_ptr<ShareGroup> share_group = nullptr);
+    ~Context();
 
     void set_output_callback(GLLayerOutputFun callback, void* user_data);
+    void set_message_callback(GLLayerMessageFun callback, void* user_data);
+    void set_async_output(bool enabled, std::size_t capacity, GLLayerDropPolicy policy);
+    void flush_output();
+    std::uint64_t dropped_message_count() const;
+    void set_message_dedup(bool enabled, std::chrono::milliseconds summary_interval);
+
+    // Takes over the output, deduplication and rule settings of another context. Asynchronous output is not copied.
+    void inherit_settings(const Context& other);
+
+    void set_rule_mask(std::uint32_t mask);
+    std::uint32_t get_rule_mask() const { return rule_mask; }
+
+    void set_sampling(GLLayerSamplingMode mode, std::uint32_t period);
+    // Reports the redundant state changes of the frame, and starts the next one.
+    void end_frame();
+    GLLayerFrameStats get_frame_stats() const { return last_frame_stats; }
+
+    // Decides whether the call about to be made to entry_point is sampled. Calls that are not sampled only update shadow
+    // state, and report nothing.
+    void begin_call(EntryPoint entry_point) {
+        if (sampling_mode == GL_LAYER_SAMPLE_CALLS) {
+            std::uint32_t& countdown = sample_countdowns[static_cast<std::size_t>(entry_point)];
+            sampled = --countdown == 0;
+            if (sampled) countdown = sampling_period;
+        }
+    }
+
+    // Whether calls to this entry point need to be looked at, to validate them with the current rule mask or to record
+    // them. Always false for EntryPoint::Unknown, so this also filters out the functions the layer does not validate.
+    bool entry_point_enabled(EntryPoint entry_point) const {
+        return entry_point_flags[static_cast<std::size_t>(entry_point)] != 0;
+    }
+
+    // Records a call to EP while a trace is recorded, then validates it if one of its rules is enabled. Every way into
+    // the layer ends up here.
+    template<EntryPoint EP, auto Method, typename... Args>
+    void call(Args... args) {
+        std::uint8_t flags = entry_point_flags[static_cast<std::size_t>(EP)];
+        if (flags & entry_point_traced) trace->record<EP>(args...);
+        if (flags & entry_point_validated) {
+            begin_call(EP);
+            (this->*Method)(args...);
+        }
+    }
+
+    // Records every call to a validated function to a file at path, replacing the trace recorded so far. Returns false
+    // if the file could not be created.
+    bool start_trace(const char* path, std::uint64_t size);
+    void stop_trace();
+
+    // Resolves the entry point for a call, using func_ptr to skip the name lookup on repeated calls.
+    EntryPoint resolve_entry_point(const char* name, const void* func_ptr) {
+        EntryPoint entry_point;
+        if (dispatch_cache.find(func_ptr, entry_point)) {
+            return entry_point;
+        }
+
+        entry_point = find_entry_point(name);
+        dispatch_cache.insert(func_ptr, entry_point);
+        return entry_point;
+    }
 
     void glCompileShader(GLuint program);
+    void glDeleteShader(GLuint shader);
     void glGetShaderiv(GLuint program, GLenum param, GLint* params);
     void glAttachShader(GLuint program, GLuint shader);
 
@@ -24,28 +137,268 @@ public:
     void glUseProgram(GLuint program);
     void glDeleteProgram(GLuint program);
 
-    void validate_program_bound(std::string_view func_name);
-    bool validate_program_status(GLuint program);
+    void glEnable(GLenum cap);
+    void glDisable(GLenum cap);
+    void glActiveTexture(GLenum texture);
+    void glBindTexture(GLenum target, GLuint texture);
+    void glDeleteTextures(GLsizei n, const GLuint* textures);
+    void glBindBuffer(GLenum target, GLuint buffer);
+    void glBindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void glDeleteBuffers(GLsizei n, const GLuint* buffers);
+    void glBindVertexArray(GLuint array);
+    void glDeleteVertexArrays(GLsizei n, const GLuint* arrays);
+    void glBlendFunc(GLenum sfactor, GLenum dfactor);
+    void glDepthFunc(GLenum func);
+
+    void glUniform1f(GLint location, GLfloat v0);
+    void glUniform2f(GLint location, GLfloat v0, GLfloat v1);
+    void glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+    void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+    void glUniform1i(GLint location, GLint v0);
+    void glUniform2i(GLint location, GLint v0, GLint v1);
+    void glUniform3i(GLint location, GLint v0, GLint v1, GLint v2);
+    void glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3);
+    void glUniform1ui(GLint location, GLuint v0);
+    void glUniform2ui(GLint location, GLuint v0, GLuint v1);
+    void glUniform3ui(GLint location, GLuint v0, GLuint v1, GLuint v2);
+    void glUniform4ui(GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3);
+    void glUniform1fv(GLint location, GLsizei count, const GLfloat* value);
+    void glUniform2fv(GLint location, GLsizei count, const GLfloat* value);
+    void glUniform3fv(GLint location, GLsizei count, const GLfloat* value);
+    void glUniform4fv(GLint location, GLsizei count, const GLfloat* value);
+    void glUniform1iv(GLint location, GLsizei count, const GLint* value);
+    void glUniform2iv(GLint location, GLsizei count, const GLint* value);
+    void glUniform3iv(GLint location, GLsizei count, const GLint* value);
+    void glUniform4iv(GLint location, GLsizei count, const GLint* value);
+    void glUniform1uiv(GLint location, GLsizei count, const GLuint* value);
+    void glUniform2uiv(GLint location, GLsizei count, const GLuint* value);
+    void glUniform3uiv(GLint location, GLsizei count, const GLuint* value);
+    void glUniform4uiv(GLint location, GLsizei count, const GLuint* value);
+    void glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUniformMatrix2x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUniformMatrix3x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUniformMatrix2x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUniformMatrix4x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUniformMatrix3x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+    void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+    void glDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+    void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+    void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount);
+
+    void glProgramUniform1f(GLuint program, GLint location, GLfloat v0);
+    void glProgramUniform2f(GLuint program, GLint location, GLfloat v0, GLfloat v1);
+    void glProgramUniform3f(GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+    void glProgramUniform4f(GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+    void glProgramUniform1i(GLuint program, GLint location, GLint v0);
+    void glProgramUniform2i(GLuint program, GLint location, GLint v0, GLint v1);
+    void glProgramUniform3i(GLuint program, GLint location, GLint v0, GLint v1, GLint v2);
+    void glProgramUniform4i(GLuint program, GLint location, GLint v0, GLint v1, GLint v2, GLint v3);
+    void glProgramUniform1ui(GLuint program, GLint location, GLuint v0);
+    void glProgramUniform2ui(GLuint program, GLint location, GLuint v0, GLuint v1);
+    void glProgramUniform3ui(GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2);
+    void glProgramUniform4ui(GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3);
+    void glProgramUniform1fv(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+    void glProgramUniform2fv(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+    void glProgramUniform3fv(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+    void glProgramUniform4fv(GLuint program, GLint location, GLsizei count, const GLfloat* value);
+    void glProgramUniform1iv(GLuint program, GLint location, GLsizei count, const GLint* value);
+    void glProgramUniform2iv(GLuint program, GLint location, GLsizei count, const GLint* value);
+    void glProgramUniform3iv(GLuint program, GLint location, GLsizei count, const GLint* value);
+    void glProgramUniform4iv(GLuint program, GLint location, GLsizei count, const GLint* value);
+    void glProgramUniform1uiv(GLuint program, GLint location, GLsizei count, const GLuint* value);
+    void glProgramUniform2uiv(GLuint program, GLint location, GLsizei count, const GLuint* value);
+    void glProgramUniform3uiv(GLuint program, GLint location, GLsizei count, const GLuint* value);
+    void glProgramUniform4uiv(GLuint program, GLint location, GLsizei count, const GLuint* value);
+    void glProgramUniformMatrix2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glProgramUniformMatrix3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glProgramUniformMatrix4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glProgramUniformMatrix2x3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glProgramUniformMatrix3x2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glProgramUniformMatrix2x4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glProgramUniformMatrix4x2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glProgramUniformMatrix3x4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glProgramUniformMatrix4x3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+    GLLayerCompileStats get_compile_stats() const;
+    const std::shared_ptr<ShareGroup>& get_share_group() const { return share_group; }
+
+    // Returns false after reporting that no program is bound.
+    bool validate_program_bound(EntryPoint entry_point);
+    // Returns the program if it can be used, or null after reporting why not.
+    const Program* validate_program_status(GLuint program, EntryPoint entry_point = EntryPoint::glUseProgram);
+    void validate_draw(EntryPoint entry_point);
+
+    // Queries the active uniforms of a successfully linked program, if that was not done since it was last linked.
+    void reflect_uniforms(const Program& program_info);
 
 private:
     Version gl_version;
 
-    GLLayerOutputFun output_fun = nullptr;
-    void* output_user_data = nullptr;
+    MessageSink sink{};
+    std::unique_ptr<AsyncOutput> async_output{};
+    std::size_t async_capacity = 0;
+    GLLayerDropPolicy async_policy = GL_LAYER_DROP_NEWEST;
+    // Messages dropped by async outputs that were already shut down.
+    std::uint64_t dropped_messages = 0;
+
+    // Repeats of a message for the same object are only counted. They are summarized by end_frame() or the async writer
+    // once summary_interval passed.
+    MessageDeduplicator dedup{};
+    bool dedup_enabled = true;
+    std::chrono::milliseconds summary_interval{ 1000 };
     ContextGLFunctions gl;
     GLuint current_program_handle = 0;
+    // The program glUseProgram last found usable, and programs.changes_count() from before it was looked up. Binding it
+    // again skips the checks until a program changes.
+    GLuint validated_program = 0;
+    std::uint64_t validated_program_changes = 0;
+
+    // Bumped by every change of this context's state that draw validation depends on: the bound program and vertex
+    // array, and the first write of a uniform. A draw that passed validation is not checked again until this or a
+    // program changes.
+    std::uint64_t draw_state_epoch = 1;
+    std::uint64_t validated_draw_epoch = 0;
+    std::uint64_t validated_draw_changes = 0;
+
+    void bind_program(GLuint program) {
+        if (program != current_program_handle) {
+            current_program_handle = program;
+            ++draw_state_epoch;
+        }
+    }
+
+    // Checks a call that uploads count values of set_type (GL_FLOAT_VEC3 for glUniform3f) to location of program, and
+    // records the write. args are the arguments of the call.
+    template<typename... Args>
+    void set_uniform(EntryPoint entry_point, GLuint program, GLenum set_type, GLint location, GLsizei count, const void* values,
+                     Args... args);
+    // Same for glUniform calls, which set the uniforms of the bound program.
+    template<typename... Args>
+    void set_bound_uniform(EntryPoint entry_point, GLenum set_type, GLint location, GLsizei count, const void* values, Args... args);
+    // Finds a program and reflects its uniforms if that was not done yet.
+    const Program* find_reflected_program(GLuint program);
+
+    std::uint32_t rule_mask = compiled_rules;
+    // Derived from rule_mask and whether a trace is recorded, with one extra entry for EntryPoint::Unknown that is never
+    // set.
+    static constexpr std::uint8_t entry_point_validated = 1;
+    static constexpr std::uint8_t entry_point_traced = 2;
+    std::uint8_t entry_point_flags[entry_point_count + 1] = {};
+    void update_entry_point_flags();
+
+    std::unique_ptr<TraceWriter> trace{};
+
+    // Only ever true for rules that are compiled in, see set_rule_mask().
+    bool rule_enabled(std::uint32_t rule) const { return (rule_mask & rule) != 0; }
+
+    // With sampling, sampled is true for the calls that are validated. In frame mode it is updated once per frame.
+    GLLayerSamplingMode sampling_mode = GL_LAYER_SAMPLE_ALL;
+    std::uint32_t sampling_period = 1;
+    std::uint32_t frame_countdown = 1;
+    std::uint32_t sample_countdowns[entry_point_count] = {};
+    bool sampled = true;
+
+    // Only tracked while the redundant state rule is enabled.
+    StateShadow state{};
+
+    // Counted during the frame, and reported by end_frame(). Runs of redundant binds of the same program share an entry
+    // in redundant_binds, so this only grows when the bound program changes.
+    std::uint32_t state_calls[entry_point_count] = {};
+    std::uint32_t redundant_calls[entry_point_count] = {};
+    std::vector<std::pair<GLuint, std::uint32_t>> redundant_binds{};
+    std::uint64_t frames_ended = 0;
+    GLLayerFrameStats last_frame_stats{};
+
+    void count_state_change(EntryPoint entry_point, bool redundant) {
+        // Some state is also tracked for other rules.
+        if (!rule_enabled(GL_LAYER_RULE_REDUNDANT_STATE)) return;
+
+        auto index = static_cast<std::size_t>(entry_point);
+        ++state_calls[index];
+        if (redundant) ++redundant_calls[index];
+    }
+
+    void count_program_bind(GLuint program) {
+        bool redundant = program == current_program_handle;
+        count_state_change(EntryPoint::glUseProgram, redundant);
+        if (!redundant) return;
+
+        if (redundant_binds.empty() || redundant_binds.back().first != program) {
+            redundant_binds.emplace_back(program, 0);
+        }
+        ++redundant_binds.back().second;
+    }
+
+    // Uploads of the frame per program, for the redundant uniforms rule. Consecutive uploads mostly go to the same
+    // program, so the entry used last is tried first.
+    struct UniformUploads {
+        GLuint program;
+        std::uint32_t uploads;
+        std::uint32_t redundant;
+        std::uint64_t redundant_bytes;
+    };
+    std::vector<UniformUploads> uniform_uploads{};
+    std::size_t last_uniform_uploads = 0;
+
+    // redundant_bytes is 0 if the upload changed a value.
+    void count_uniform_upload(GLuint program, std::size_t redundant_bytes) {
+        if (last_uniform_uploads >= uniform_uploads.size() || uniform_uploads[last_uniform_uploads].program != program) {
+            auto it = std::find_if(uniform_uploads.begin(), uniform_uploads.end(), [program](const UniformUploads& uploads) {
+                return uploads.program == program;
+            });
+            if (it == uniform_uploads.end()) it = uniform_uploads.insert(it, UniformUploads{ program, 0, 0, 0 });
+            last_uniform_uploads = static_cast<std::size_t>(it - uniform_uploads.begin());
+        }
+
+        UniformUploads& uploads = uniform_uploads[last_uniform_uploads];
+        ++uploads.uploads;
+        if (redundant_bytes > 0) {
+            ++uploads.redundant;
+            uploads.redundant_bytes += redundant_bytes;
+        }
+    }
 
-    std::unordered_map<GLuint, Shader> shaders{};
-    std::unordered_map<GLuint, Program> programs{};
+    void report_frame();
 
+    DispatchCache dispatch_cache{};
+
+    std::shared_ptr<ShareGroup> share_group;
+
+    // Track compiles and links from their start until the application observed them finishing. started is the counter
+    // of the kind of job, pending the flag on the object.
+    void begin_pending(bool& pending, unsigned int GLLayerCompileStats::*started);
+    void end_pending(bool& pending);
+    void count_completion_poll();
+
+    ObjectTable<Shader>& shaders;
+    ObjectTable<Program>& programs;
+    BitsetPool& uniform_bitsets;
+
+    void deliver(const GLLayerMessage& message);
+    void report_suppressed();
+    // Forgets the reported messages of a deleted object, so a new object with its handle is reported again.
+    void forget_messages(GLuint handle);
+
+    // Reports a problem found in a call to entry_point. The first handle is the object the message is about, it is used
+    // to deduplicate repeats. args are the arguments of the call.
     template<typename... Args>
-    void output_fmt(const char* fmt, Args&& ... args) {
-        std::size_t size = static_cast<std::size_t>(std::snprintf(nullptr, 0, fmt, args...)) + 1; // Extra space for null terminator
-        assert(size > 0 && "Error during formatting");
-        char* buf = new char[size];
-        std::snprintf(buf, size, fmt, args...);
-        output_fun(buf, output_user_data);
-        delete[] buf;
+    void report(MessageId id, EntryPoint entry_point, std::initializer_list<GLuint> handles, Args... args) {
+        std::uint32_t rule = message_rule(id);
+        if (!sampled || (rule != GL_LAYER_RULE_NONE && !rule_enabled(rule))) {
+            return;
+        }
+
+        GLuint subject = handles.size() > 0 ? *handles.begin() : 0;
+        if (dedup_enabled && !dedup.first_occurrence(id, subject)) {
+            return;
+        }
+
+        deliver(make_message(id, entry_point, handles, args...));
     }
 };
 
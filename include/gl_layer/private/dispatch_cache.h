@@ -0,0 +1,63 @@
+#ifndef GL_VALIDATION_LAYER_DISPATCH_CACHE_H_
+#define GL_VALIDATION_LAYER_DISPATCH_CACHE_H_
+
+#include <gl_layer/private/entry_points.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace gl_layer {
+
+// Caches which entry point a function pointer resolves to, so a repeated call costs a pointer hash and a probe instead
+// of hashing and comparing the function name. Functions the layer does not validate are cached as EntryPoint::Unknown.
+// Once the table is 3/4 full no more pointers are added, and callers fall back to the name lookup.
+class DispatchCache {
+public:
+    static constexpr std::size_t capacity = 1024;
+
+    // Returns false if func_ptr is not cached yet.
+    bool find(const void* func_ptr, EntryPoint& entry_point) const {
+        if (func_ptr == nullptr) return false;
+
+        for (std::size_t slot = hash(func_ptr);; slot = (slot + 1) & mask) {
+            if (keys[slot] == func_ptr) {
+                entry_point = values[slot];
+                return true;
+            }
+            if (keys[slot] == nullptr) return false;
+        }
+    }
+
+    void insert(const void* func_ptr, EntryPoint entry_point) {
+        if (func_ptr == nullptr || count >= capacity / 4 * 3) return;
+
+        std::size_t slot = hash(func_ptr);
+        while (keys[slot] != nullptr) {
+            if (keys[slot] == func_ptr) return;
+            slot = (slot + 1) & mask;
+        }
+        keys[slot] = func_ptr;
+        values[slot] = entry_point;
+        ++count;
+    }
+
+    std::size_t size() const { return count; }
+
+private:
+    static constexpr std::size_t mask = capacity - 1;
+
+    static std::size_t hash(const void* ptr) {
+        // Function addresses are aligned, so drop the low bits before mixing.
+        auto bits = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ptr)) >> 4;
+        return static_cast<std::size_t>((bits * 0x9E3779B97F4A7C15ull) >> 54) & mask;
+    }
+
+    std::array<const void*, capacity> keys{};
+    std::array<EntryPoint, capacity> values{};
+    std::size_t count = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef GL_VALIDATION_LAYER_ENTRY_POINTS_H_
+#define GL_VALIDATION_LAYER_ENTRY_POINTS_H_
+
+#include <gl_layer/context.h>
+#include <gl_layer/private/name_table.h>
+#include <gl_layer/private/profile.h>
+
+#include <cstdint>
+#include <string_view>
+
+// Every OpenGL function the layer validates, with the rules it matters for and its parameters. Each entry must have a
+// matching Context method with the same name and the same parameters as the OpenGL function, the dispatch code is
+// generated from this list. A call is skipped unless one of its rules is enabled, so an entry must list every rule that
+// needs the state it tracks. The parameter kinds decide how raw arguments are printed in messages. Entry point ids are
+// part of the public API, so new entries must be added at the end.
+#define GL_LAYER_ENTRY_POINTS(X)                                                                                       \
+    X(glCompileShader, R(SHADER_COMPILE), P(shader, Uint))                                                             \
+    X(glDeleteShader, R(SHADER_COMPILE), P(shader, Uint))                                                              \
+    X(glGetShaderiv, R(SHADER_COMPILE), P(shader, Uint) P(pname, Enum) P(params, Pointer))                             \
+    X(glAttachShader, R(SHADER_COMPILE) R(PROGRAM_LINK), P(program, Uint) P(shader, Uint))                             \
+    X(glGetProgramiv, R(PROGRAM_LINK), P(program, Uint) P(pname, Enum) P(params, Pointer))                             \
+    X(glLinkProgram, R(PROGRAM_LINK), P(program, Uint))                                                                \
+    X(glUseProgram, R(PROGRAM_LINK) R(PROGRAM_BOUND) R(REDUNDANT_STATE) R(DRAW_STATE) R(UNIFORM)                       \
+      R(REDUNDANT_UNIFORMS), P(program, Uint))                                                                         \
+    X(glDeleteProgram, R(PROGRAM_LINK), P(program, Uint))                                                              \
+    X(glEnable, R(REDUNDANT_STATE), P(cap, Enum))                                                                      \
+    X(glDisable, R(REDUNDANT_STATE), P(cap, Enum))                                                                     \
+    X(glActiveTexture, R(REDUNDANT_STATE), P(texture, Enum))                                                           \
+    X(glBindTexture, R(REDUNDANT_STATE), P(target, Enum) P(texture, Uint))                                             \
+    X(glDeleteTextures, R(REDUNDANT_STATE), P(n, Int) P(textures, Pointer))                                            \
+    X(glBindBuffer, R(REDUNDANT_STATE), P(target, Enum) P(buffer, Uint))                                               \
+    X(glBindBufferBase, R(REDUNDANT_STATE), P(target, Enum) P(index, Uint) P(buffer, Uint))                            \
+    X(glBindBufferRange, R(REDUNDANT_STATE),                                                                           \
+      P(target, Enum) P(index, Uint) P(buffer, Uint) P(offset, Int) P(size, Int))                                      \
+    X(glDeleteBuffers, R(REDUNDANT_STATE), P(n, Int) P(buffers, Pointer))                                              \
+    X(glBindVertexArray, R(REDUNDANT_STATE) R(DRAW_STATE), P(array, Uint))                                             \
+    X(glDeleteVertexArrays, R(REDUNDANT_STATE) R(DRAW_STATE), P(n, Int) P(arrays, Pointer))                            \
+    X(glBlendFunc, R(REDUNDANT_STATE), P(sfactor, Enum) P(dfactor, Enum))                                              \
+    X(glDepthFunc, R(REDUNDANT_STATE), P(func, Enum))                                                                  \
+    X(glUniform1f, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS), P(location, Int) P(v0, Float))     \
+    X(glUniform2f, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                    \
+      P(location, Int) P(v0, Float) P(v1, Float))                                                                      \
+    X(glUniform3f, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                    \
+      P(location, Int) P(v0, Float) P(v1, Float) P(v2, Float))                                                         \
+    X(glUniform4f, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                    \
+      P(location, Int) P(v0, Float) P(v1, Float) P(v2, Float) P(v3, Float))                                            \
+    X(glUniform1i, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS), P(location, Int) P(v0, Int))       \
+    X(glUniform2i, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                    \
+      P(location, Int) P(v0, Int) P(v1, Int))                                                                          \
+    X(glUniform3i, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                    \
+      P(location, Int) P(v0, Int) P(v1, Int) P(v2, Int))                                                               \
+    X(glUniform4i, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                    \
+      P(location, Int) P(v0, Int) P(v1, Int) P(v2, Int) P(v3, Int))                                                    \
+    X(glUniform1ui, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS), P(location, Int) P(v0, Uint))     \
+    X(glUniform2ui, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(v0, Uint) P(v1, Uint))                                                                        \
+    X(glUniform3ui, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(v0, Uint) P(v1, Uint) P(v2, Uint))                                                            \
+    X(glUniform4ui, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(v0, Uint) P(v1, Uint) P(v2, Uint) P(v3, Uint))                                                \
+    X(glUniform1fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform2fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform3fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform4fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform1iv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform2iv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform3iv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform4iv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                   \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform1uiv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                  \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform2uiv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                  \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform3uiv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                  \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniform4uiv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                  \
+      P(location, Int) P(count, Int) P(value, Pointer))                                                                \
+    X(glUniformMatrix2fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                             \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glUniformMatrix3fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                             \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glUniformMatrix4fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                             \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glUniformMatrix2x3fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                           \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glUniformMatrix3x2fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                           \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glUniformMatrix2x4fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                           \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glUniformMatrix4x2fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                           \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glUniformMatrix3x4fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                           \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glUniformMatrix4x3fv, R(PROGRAM_BOUND) R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                           \
+      P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                                          \
+    X(glDrawArrays, R(PROGRAM_LINK) R(PROGRAM_BOUND) R(DRAW_STATE), P(mode, Enum) P(first, Int) P(count, Int))         \
+    X(glDrawElements, R(PROGRAM_LINK) R(PROGRAM_BOUND) R(DRAW_STATE),                                                  \
+      P(mode, Enum) P(count, Int) P(type, Enum) P(indices, Pointer))                                                   \
+    X(glDrawArraysInstanced, R(PROGRAM_LINK) R(PROGRAM_BOUND) R(DRAW_STATE),                                           \
+      P(mode, Enum) P(first, Int) P(count, Int) P(instancecount, Int))                                                 \
+    X(glDrawElementsInstanced, R(PROGRAM_LINK) R(PROGRAM_BOUND) R(DRAW_STATE),                                         \
+      P(mode, Enum) P(count, Int) P(type, Enum) P(indices, Pointer) P(instancecount, Int))                             \
+    X(glProgramUniform1f, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                              \
+      P(program, Uint) P(location, Int) P(v0, Float))                                                                  \
+    X(glProgramUniform2f, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                              \
+      P(program, Uint) P(location, Int) P(v0, Float) P(v1, Float))                                                     \
+    X(glProgramUniform3f, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                              \
+      P(program, Uint) P(location, Int) P(v0, Float) P(v1, Float) P(v2, Float))                                        \
+    X(glProgramUniform4f, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                              \
+      P(program, Uint) P(location, Int) P(v0, Float) P(v1, Float) P(v2, Float) P(v3, Float))                           \
+    X(glProgramUniform1i, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                              \
+      P(program, Uint) P(location, Int) P(v0, Int))                                                                    \
+    X(glProgramUniform2i, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                              \
+      P(program, Uint) P(location, Int) P(v0, Int) P(v1, Int))                                                         \
+    X(glProgramUniform3i, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                              \
+      P(program, Uint) P(location, Int) P(v0, Int) P(v1, Int) P(v2, Int))                                              \
+    X(glProgramUniform4i, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                              \
+      P(program, Uint) P(location, Int) P(v0, Int) P(v1, Int) P(v2, Int) P(v3, Int))                                   \
+    X(glProgramUniform1ui, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(v0, Uint))                                                                   \
+    X(glProgramUniform2ui, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(v0, Uint) P(v1, Uint))                                                       \
+    X(glProgramUniform3ui, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(v0, Uint) P(v1, Uint) P(v2, Uint))                                           \
+    X(glProgramUniform4ui, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(v0, Uint) P(v1, Uint) P(v2, Uint) P(v3, Uint))                               \
+    X(glProgramUniform1fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform2fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform3fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform4fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform1iv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform2iv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform3iv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform4iv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                             \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform1uiv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                            \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform2uiv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                            \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform3uiv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                            \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniform4uiv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                            \
+      P(program, Uint) P(location, Int) P(count, Int) P(value, Pointer))                                               \
+    X(glProgramUniformMatrix2fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                       \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                         \
+    X(glProgramUniformMatrix3fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                       \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                         \
+    X(glProgramUniformMatrix4fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                       \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                         \
+    X(glProgramUniformMatrix2x3fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                     \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                         \
+    X(glProgramUniformMatrix3x2fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                     \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                         \
+    X(glProgramUniformMatrix2x4fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                     \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                         \
+    X(glProgramUniformMatrix4x2fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                     \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                         \
+    X(glProgramUniformMatrix3x4fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                     \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))                         \
+    X(glProgramUniformMatrix4x3fv, R(DRAW_STATE) R(UNIFORM) R(REDUNDANT_UNIFORMS),                                     \
+      P(program, Uint) P(location, Int) P(count, Int) P(transpose, Boolean) P(value, Pointer))
+
+namespace gl_layer {
+
+enum class EntryPoint : std::uint16_t {
+#define GL_LAYER_ENTRY_POINT_ENUM(name, rules, params) name,
+    GL_LAYER_ENTRY_POINTS(GL_LAYER_ENTRY_POINT_ENUM)
+#undef GL_LAYER_ENTRY_POINT_ENUM
+    Count,
+    // Any OpenGL function the layer does not validate.
+    Unknown = Count
+};
+
+constexpr std::size_t entry_point_count = static_cast<std::size_t>(EntryPoint::Count);
+
+enum class ParamKind : std::uint8_t {
+    Int,
+    Uint,
+    Enum,
+    Float,
+    Boolean,
+    Pointer,
+};
+
+struct ParamInfo {
+    std::string_view name;
+    ParamKind kind;
+};
+
+// The longest validated entry points (glProgramUniform4*) take 6 arguments.
+constexpr std::size_t max_entry_point_params = 8;
+
+struct EntryPointParams {
+    ParamInfo params[max_entry_point_params];
+};
+
+namespace detail {
+constexpr std::array<std::string_view, entry_point_count> entry_point_names = {
+#define GL_LAYER_ENTRY_POINT_NAME(name, rules, params) #name,
+    GL_LAYER_ENTRY_POINTS(GL_LAYER_ENTRY_POINT_NAME)
+#undef GL_LAYER_ENTRY_POINT_NAME
+};
+
+constexpr NameTable<entry_point_count> entry_point_table{ entry_point_names };
+
+constexpr EntryPointParams entry_point_params[entry_point_count] = {
+#define P(name, kind) ParamInfo{ #name, ParamKind::kind },
+#define GL_LAYER_ENTRY_POINT_PARAMS(name, rules, params) EntryPointParams{ { params } },
+    GL_LAYER_ENTRY_POINTS(GL_LAYER_ENTRY_POINT_PARAMS)
+#undef GL_LAYER_ENTRY_POINT_PARAMS
+#undef P
+};
+
+constexpr std::uint32_t entry_point_rules[entry_point_count] = {
+#define R(rule) | GL_LAYER_RULE_##rule
+#define GL_LAYER_ENTRY_POINT_RULES(name, rules, params) 0u rules,
+    GL_LAYER_ENTRY_POINTS(GL_LAYER_ENTRY_POINT_RULES)
+#undef GL_LAYER_ENTRY_POINT_RULES
+#undef R
+};
+
+constexpr std::size_t entry_point_param_counts[entry_point_count] = {
+#define P(name, kind) + 1
+#define GL_LAYER_ENTRY_POINT_PARAM_COUNT(name, rules, params) 0 params,
+    GL_LAYER_ENTRY_POINTS(GL_LAYER_ENTRY_POINT_PARAM_COUNT)
+#undef GL_LAYER_ENTRY_POINT_PARAM_COUNT
+#undef P
+};
+}
+
+constexpr EntryPoint find_entry_point(std::string_view name) {
+    std::size_t index = detail::entry_point_table.find(name);
+    if (index == detail::entry_point_table.npos) return EntryPoint::Unknown;
+    return static_cast<EntryPoint>(index);
+}
+
+constexpr std::string_view entry_point_name(EntryPoint ep) {
+    if (ep >= EntryPoint::Count) return "<unknown>";
+    return detail::entry_point_names[static_cast<std::size_t>(ep)];
+}
+
+// Parameter names and kinds, in declaration order.
+constexpr const ParamInfo* entry_point_params(EntryPoint ep) {
+    return detail::entry_point_params[static_cast<std::size_t>(ep)].params;
+}
+
+constexpr std::size_t entry_point_param_count(EntryPoint ep) {
+    if (ep >= EntryPoint::Count) return 0;
+    return detail::entry_point_param_counts[static_cast<std::size_t>(ep)];
+}
+
+// GLLayerRule flags of the rules that need to see calls to this entry point.
+constexpr std::uint32_t entry_point_rules(EntryPoint ep) {
+    if (ep >= EntryPoint::Count) return 0;
+    return detail::entry_point_rules[static_cast<std::size_t>(ep)];
+}
+
+// Whether any rule that needs this entry point is compiled in. If not, nothing is generated for the entry point.
+constexpr bool entry_point_compiled(EntryPoint ep) {
+    return rule_compiled(entry_point_rules(ep));
+}
+
+static_assert(find_entry_point("glUseProgram") == EntryPoint::glUseProgram);
+static_assert(find_entry_point("glUniform1f") == EntryPoint::glUniform1f);
+static_assert(find_entry_point("glClear") == EntryPoint::Unknown);
+
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef GL_VALIDATION_LAYER_EPOCH_H_
+#define GL_VALIDATION_LAYER_EPOCH_H_
+
+namespace gl_layer {
+
+// Epoch based reclamation, for objects that other threads read without taking a lock. A reader publishes the epoch it
+// started in for as long as an EpochGuard is alive, and memory a writer unlinked is only freed once every reader that
+// could still see it has finished. Entering and leaving cost a store to a slot owned by the calling thread, readers
+// never write to shared cache lines.
+class EpochGuard {
+public:
+    // An inactive guard does nothing, for data that is not shared between threads at the moment.
+    explicit EpochGuard(bool active = true);
+    ~EpochGuard();
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+private:
+    bool active;
+};
+
+// Frees object with deleter once no EpochGuard that exists right now is left. The object must already be unreachable
+// for new readers.
+void retire(void* object, void (*deleter)(void*));
+
+template<typename T>
+void retire(T* object) {
+    retire(object, [](void* p) { delete static_cast<T*>(p); });
+}
+
+// Frees every retired object no reader can see anymore. retire() calls this every so often.
+void reclaim_retired();
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef GL_VALIDATION_LAYER_MESSAGE_QUEUE_H_
+#define GL_VALIDATION_LAYER_MESSAGE_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace gl_layer {
+
+// Bounded lock-free queue for any number of producers and consumers. Every cell carries a sequence number telling
+// whether it is ready to be written or read for the current lap around the ring, so producers and consumers only
+// contend on their own position counter. The capacity is rounded up to a power of two.
+template<typename T>
+class MessageQueue {
+public:
+    explicit MessageQueue(std::size_t min_capacity) {
+        std::size_t capacity = 2;
+        while (capacity < min_capacity) capacity <<= 1;
+
+        cells = std::make_unique<Cell[]>(capacity);
+        mask = capacity - 1;
+        for (std::size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns false if the queue is full.
+    bool try_push(const T& value) {
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.data = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty.
+    bool try_pop(T& value) {
+        std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.data;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence{ 0 };
+        T data{};
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask = 0;
+    // Keep the positions on separate cache lines, producers and consumers would otherwise invalidate each other.
+    alignas(64) std::atomic<std::size_t> enqueue_pos{ 0 };
+    alignas(64) std::atomic<std::size_t> dequeue_pos{ 0 };
+};
+
+}
+
+#endif
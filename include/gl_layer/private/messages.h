@@ -0,0 +1,306 @@
+#ifndef GL_VALIDATION_LAYER_MESSAGES_H_
+#define GL_VALIDATION_LAYER_MESSAGES_H_
+
+#include <gl_layer/context.h>
+#include <gl_layer/private/types.h>
+#include <gl_layer/private/entry_points.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <type_traits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Every message the layer can report, with its severity, the rule it belongs to and its text. Messages are only reported
+// while their rule is enabled, messages of rule NONE come from the layer itself and are always reported. The id
+// identifies the problem, not the wording, so it stays stable when the text changes. Message ids are part of the public
+// API, so new messages must be added at the end.
+#define GL_LAYER_MESSAGES(X)                                                                                                            \
+    X(ShaderAlreadyCompiled, WARNING, SHADER_COMPILE, "Shader is already compiled.")                                                    \
+    X(InvalidShaderHandle, ERROR, SHADER_COMPILE, "Invalid shader handle.")                                                             \
+    X(ShaderCompileStatusUnchecked, WARNING, SHADER_COMPILE, "Always check shader compilation status before trying to use the object.") \
+    X(ShaderCompileFailed, ERROR, SHADER_COMPILE, "Attached shader has a compilation error.")                                           \
+    X(InvalidProgramHandle, ERROR, PROGRAM_LINK, "Invalid program handle.")                                                             \
+    X(ProgramLinkStatusUnchecked, WARNING, PROGRAM_LINK, "Always check program link status before trying to use the object.")           \
+    X(ProgramLinkFailed, ERROR, PROGRAM_LINK, "Program has a linker error.")                                                            \
+    X(NoProgramBound, ERROR, PROGRAM_BOUND, "No program bound.")                                                                        \
+    /* args: suppressed message id, repeat count */                                                                                     \
+    X(RepeatsSuppressed, INFO, NONE, "Suppressed %llu repeat(s) of %s for object %u.")                                                  \
+    /* args: repeat count */                                                                                                            \
+    X(RedundantProgramBinds, WARNING, REDUNDANT_STATE, "Program %u was bound %llu time(s) this frame while already bound.")             \
+    /* args: redundant call count, call count */                                                                                        \
+    X(RedundantStateChanges, WARNING, REDUNDANT_STATE, "%llu of %llu call(s) this frame set state to the value it already had.")        \
+    X(NoVertexArrayBound, WARNING, DRAW_STATE, "No vertex array object bound, this is an error in core profile contexts.")              \
+    /* args: location */                                                                                                                \
+    X(UniformNotSet, WARNING, DRAW_STATE, "Uniform at location %llu of program %u was not set since the program was linked.")           \
+    X(InvalidUniformLocation, ERROR, UNIFORM, "No active uniform at this location in the program.")                                     \
+    X(UniformTypeMismatch, ERROR, UNIFORM, "Function does not match the type of the uniform at this location.")                         \
+    X(InvalidUniformCount, ERROR, UNIFORM, "Count is negative, or larger than 1 for a uniform that is not an array.")                   \
+    /* args: redundant upload count, upload count, redundant bytes */                                                                   \
+    X(RedundantUniformUploads, WARNING, REDUNDANT_UNIFORMS, "Program %u: %llu of %llu uniform upload(s) changed nothing, %llu bytes.")
+
+namespace gl_layer {
+
+enum class MessageId : std::uint16_t {
+#define GL_LAYER_MESSAGE_ENUM(name, severity, rule, text) name,
+    GL_LAYER_MESSAGES(GL_LAYER_MESSAGE_ENUM)
+#undef GL_LAYER_MESSAGE_ENUM
+    Count
+};
+
+constexpr std::string_view message_id_name(MessageId id) {
+    constexpr std::string_view names[] = {
+#define GL_LAYER_MESSAGE_NAME(name, severity, rule, text) #name,
+        GL_LAYER_MESSAGES(GL_LAYER_MESSAGE_NAME)
+#undef GL_LAYER_MESSAGE_NAME
+    };
+    return id < MessageId::Count ? names[static_cast<std::size_t>(id)] : "<unknown>";
+}
+
+constexpr GLLayerSeverity message_severity(MessageId id) {
+    constexpr GLLayerSeverity severities[] = {
+#define GL_LAYER_MESSAGE_SEVERITY(name, severity, rule, text) GL_LAYER_SEVERITY_##severity,
+        GL_LAYER_MESSAGES(GL_LAYER_MESSAGE_SEVERITY)
+#undef GL_LAYER_MESSAGE_SEVERITY
+    };
+    return id < MessageId::Count ? severities[static_cast<std::size_t>(id)] : GL_LAYER_SEVERITY_ERROR;
+}
+
+constexpr std::uint32_t message_rule(MessageId id) {
+    constexpr std::uint32_t rules[] = {
+#define GL_LAYER_MESSAGE_RULE(name, severity, rule, text) GL_LAYER_RULE_##rule,
+        GL_LAYER_MESSAGES(GL_LAYER_MESSAGE_RULE)
+#undef GL_LAYER_MESSAGE_RULE
+    };
+    return id < MessageId::Count ? rules[static_cast<std::size_t>(id)] : GL_LAYER_RULE_NONE;
+}
+
+constexpr const char* message_text(MessageId id) {
+    constexpr const char* texts[] = {
+#define GL_LAYER_MESSAGE_TEXT(name, severity, rule, text) text,
+        GL_LAYER_MESSAGES(GL_LAYER_MESSAGE_TEXT)
+#undef GL_LAYER_MESSAGE_TEXT
+    };
+    return id < MessageId::Count ? texts[static_cast<std::size_t>(id)] : "";
+}
+
+// Raw message arguments are stored as 64 bits, floats and pointers keep their bit pattern.
+template<typename T>
+std::uint64_t to_raw_arg(T value) {
+    if constexpr (std::is_pointer_v<T>) {
+        return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        double as_double = static_cast<double>(value);
+        std::uint64_t bits;
+        std::memcpy(&bits, &as_double, sizeof(bits));
+        return bits;
+    } else if constexpr (std::is_signed_v<T>) {
+        return static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+    } else {
+        return static_cast<std::uint64_t>(value);
+    }
+}
+
+// Builds a message record for a problem found in a call to entry_point. args are the arguments of that call.
+template<typename... Args>
+GLLayerMessage make_message(MessageId id, EntryPoint entry_point, std::initializer_list<GLuint> handles, Args... args) {
+    static_assert(sizeof...(Args) <= GL_LAYER_MAX_MESSAGE_ARGS, "Too many message arguments");
+
+    GLLayerMessage message{};
+    message.id = static_cast<unsigned int>(id);
+    message.severity = message_severity(id);
+    message.entry_point = static_cast<unsigned int>(entry_point);
+    for (GLuint handle : handles) {
+        if (message.handle_count == GL_LAYER_MAX_MESSAGE_HANDLES) break;
+        message.handles[message.handle_count++] = handle;
+    }
+    ((message.args[message.arg_count++] = to_raw_arg(args)), ...);
+    return message;
+}
+
+// Renders the text of a message like snprintf: writes at most size bytes and returns the length of the full text.
+std::size_t format_message(const GLLayerMessage& message, char* buffer, std::size_t size);
+
+// Where messages go. If message_fun is set it gets the records, otherwise the text is built and passed to output_fun.
+struct MessageSink {
+    GLLayerOutputFun output_fun = nullptr;
+    void* output_user_data = nullptr;
+    GLLayerMessageFun message_fun = nullptr;
+    void* message_user_data = nullptr;
+};
+
+void deliver_message(const MessageSink& sink, const GLLayerMessage& message);
+
+// Remembers which (message, object) pairs were already reported, and counts how often each one repeated since the
+// last summary. The set only grows when a new pair is reported for the first time, repeats cost one hash probe.
+//
+// Only the thread of the context reports messages, so it changes the table and looks up entries without a lock. The
+// asynchronous writer also writes summaries, the mutex keeps it from reading the table while it changes.
+class MessageDeduplicator {
+public:
+    // Pairs that did not repeat since the last summary are forgotten when the set reaches this size, a later repeat of
+    // one of them is reported again.
+    static constexpr std::size_t max_entries = 4096;
+
+    MessageDeduplicator() : last_summary(now()) {}
+
+    // Returns true the first time this message is reported for this object. Later calls count a suppressed repeat.
+    bool first_occurrence(MessageId id, GLuint handle) {
+        std::uint64_t key = make_key(id, handle);
+        if (Entry* entry = find(key)) {
+            entry->suppressed.fetch_add(1, std::memory_order_relaxed);
+            suppressed_total.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count >= max_entries) {
+            rebuild([](const Entry& entry) { return entry.suppressed.load(std::memory_order_relaxed) > 0; });
+        }
+        if ((count + 1) * 2 > entries.size()) {
+            grow();
+        }
+        insert(key, 0);
+        return true;
+    }
+
+    // Whether there are repeats to summarize, and summary_interval passed since the last summary.
+    bool summary_due(std::chrono::milliseconds summary_interval) const {
+        return suppressed_total.load(std::memory_order_relaxed) > 0 &&
+               now() - last_summary.load(std::memory_order_relaxed) >= summary_interval.count();
+    }
+
+    // Calls f(const GLLayerMessage&) with a summary for every pair that repeated since the last call, and resets their
+    // counts. If wait is false, returns false instead of waiting for another thread that writes summaries.
+    template<typename F>
+    bool drain_suppressed(F&& f, bool wait = true) {
+        std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+        if (wait) {
+            lock.lock();
+        } else if (!lock.try_lock()) {
+            return false;
+        }
+
+        last_summary.store(now(), std::memory_order_relaxed);
+        if (suppressed_total.exchange(0, std::memory_order_relaxed) == 0) return true;
+        for (Entry& entry : entries) {
+            std::uint32_t suppressed = entry.suppressed.exchange(0, std::memory_order_relaxed);
+            if (suppressed > 0) f(summary(entry.key, suppressed));
+        }
+        return true;
+    }
+
+    // Forgets the pairs of a deleted object, after passing their summaries to f(const GLLayerMessage&). The handle may be
+    // given to a new object, whose messages are new.
+    template<typename F>
+    void forget_handle(GLuint handle, F&& f) {
+        auto of_handle = [handle](const Entry& entry) { return entry.key != 0 && static_cast<GLuint>(entry.key - 1) == handle; };
+        if (std::none_of(entries.begin(), entries.end(), of_handle)) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        rebuild([handle, &f](const Entry& entry) {
+            if (static_cast<GLuint>(entry.key - 1) != handle) return true;
+            std::uint32_t suppressed = entry.suppressed.load(std::memory_order_relaxed);
+            if (suppressed > 0) f(summary(entry.key, suppressed));
+            return false;
+        });
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        count = 0;
+        suppressed_total.store(0, std::memory_order_relaxed);
+    }
+
+    std::size_t size() const { return count; }
+
+private:
+    struct Entry {
+        Entry() = default;
+        Entry(const Entry& other) : key(other.key), suppressed(other.suppressed.load(std::memory_order_relaxed)) {}
+        Entry& operator=(const Entry& other) {
+            key = other.key;
+            suppressed.store(other.suppressed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+
+        // 0 marks an empty slot, keys are offset by one so (message 0, object 0) is still representable.
+        std::uint64_t key = 0;
+        std::atomic<std::uint32_t> suppressed{ 0 };
+    };
+
+    static std::uint64_t make_key(MessageId id, GLuint handle) {
+        return ((static_cast<std::uint64_t>(id) << 32) | handle) + 1;
+    }
+
+    static std::size_t hash(std::uint64_t key) {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static GLLayerMessage summary(std::uint64_t key, std::uint32_t suppressed) {
+        auto id = static_cast<unsigned int>((key - 1) >> 32);
+        auto handle = static_cast<GLuint>(key - 1);
+        return make_message(MessageId::RepeatsSuppressed, EntryPoint::Unknown, { handle }, id, suppressed);
+    }
+
+    Entry* find(std::uint64_t key) {
+        if (entries.empty()) return nullptr;
+
+        std::size_t mask = entries.size() - 1;
+        for (std::size_t slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+            if (entries[slot].key == key) return &entries[slot];
+            if (entries[slot].key == 0) return nullptr;
+        }
+    }
+
+    void insert(std::uint64_t key, std::uint32_t suppressed) {
+        std::size_t mask = entries.size() - 1;
+        std::size_t slot = hash(key) & mask;
+        while (entries[slot].key != 0) slot = (slot + 1) & mask;
+        entries[slot].key = key;
+        entries[slot].suppressed.store(suppressed, std::memory_order_relaxed);
+        ++count;
+    }
+
+    void grow() {
+        std::vector<Entry> old = std::move(entries);
+        entries.assign(old.empty() ? 64 : old.size() * 2, Entry{});
+        count = 0;
+        for (const Entry& entry : old) {
+            if (entry.key != 0) insert(entry.key, entry.suppressed.load(std::memory_order_relaxed));
+        }
+    }
+
+    // Keeps the entries keep(entry) returns true for. Removing from the open addressed table means placing the rest again.
+    template<typename F>
+    void rebuild(F&& keep) {
+        std::vector<Entry> old = entries;
+        std::fill(entries.begin(), entries.end(), Entry{});
+        count = 0;
+        for (const Entry& entry : old) {
+            if (entry.key != 0 && keep(entry)) insert(entry.key, entry.suppressed.load(std::memory_order_relaxed));
+        }
+    }
+
+    std::vector<Entry> entries{};
+    std::size_t count = 0;
+    std::atomic<std::uint64_t> suppressed_total{ 0 };
+    std::atomic<std::int64_t> last_summary;
+    std::mutex mutex;
+};
+
+}
+
+#endif
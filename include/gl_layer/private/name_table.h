@@ -0,0 +1,74 @@
+#ifndef GL_VALIDATION_LAYER_NAME_TABLE_H_
+#define GL_VALIDATION_LAYER_NAME_TABLE_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace gl_layer {
+
+// FNV-1a, usable both at compile time and at runtime.
+constexpr std::uint32_t hash_name(std::string_view name) {
+    std::uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr std::size_t next_pow2(std::size_t v) {
+    std::size_t result = 1;
+    while (result < v) result <<= 1;
+    return result;
+}
+
+// Maps a fixed set of names to their index in O(1). The table is open-addressed with at least twice as many slots as
+// names, so a lookup is one hash of the name, usually a single probe and a single string compare to confirm the hit.
+// When constructed from a constexpr array, the whole table is built at compile time.
+template<std::size_t N>
+class NameTable {
+public:
+    static constexpr std::size_t capacity = next_pow2(N * 2);
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    constexpr explicit NameTable(const std::array<std::string_view, N>& names) : names(names) {
+        for (std::size_t i = 0; i < N; ++i) {
+            std::uint32_t hash = hash_name(names[i]);
+            std::size_t slot = hash & mask;
+            while (slots[slot].index != empty) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = Slot{ hash, static_cast<std::uint32_t>(i) };
+        }
+    }
+
+    constexpr std::size_t find(std::string_view name) const {
+        std::uint32_t hash = hash_name(name);
+        for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+            const Slot& s = slots[slot];
+            if (s.index == empty) return npos;
+            if (s.hash == hash && names[s.index] == name) return s.index;
+        }
+    }
+
+    constexpr std::string_view name(std::size_t index) const { return names[index]; }
+    constexpr std::size_t size() const { return N; }
+
+private:
+    static constexpr std::uint32_t empty = 0xFFFFFFFFu;
+    static constexpr std::size_t mask = capacity - 1;
+
+    struct Slot {
+        std::uint32_t hash = 0;
+        std::uint32_t index = empty;
+    };
+
+    std::array<std::string_view, N> names;
+    std::array<Slot, capacity> slots{};
+};
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef GL_VALIDATION_LAYER_OBJECT_TABLE_H_
+#define GL_VALIDATION_LAYER_OBJECT_TABLE_H_
+
+#include <gl_layer/private/epoch.h>
+#include <gl_layer/private/types.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace gl_layer {
+
+// Stores OpenGL objects indexed directly by their handle. OpenGL names are small and dense, so handles index a fixed
+// radix tree of pages of consecutive handles, allocated on first use. A lookup is two shifts and three loads, with no
+// hashing and no locks.
+//
+// The table can be shared by contexts on several threads. Lookups never block: pages are never freed while the table
+// exists, and objects are immutable while concurrent. Changes go through update(), which publishes a modified copy and
+// retires the old object, so a reader inside an EpochGuard keeps a consistent snapshot. Writers lock one of a set of
+// shards picked by handle, so threads creating different objects do not wait for each other. Until set_concurrent() is
+// called, objects are changed in place and freed right away.
+template<typename T>
+class ObjectTable {
+public:
+    static constexpr std::size_t page_bits = 10;
+    static constexpr std::size_t page_size = std::size_t{1} << page_bits;
+    static constexpr std::size_t directory_bits = 10;
+    static constexpr std::size_t directory_size = std::size_t{1} << directory_bits;
+    static constexpr std::size_t root_size = std::size_t{1} << (32 - page_bits - directory_bits);
+    static constexpr std::size_t shard_count = 16;
+
+    ObjectTable() : root(std::make_unique<std::atomic<Directory*>[]>(root_size)) {}
+    ObjectTable(const ObjectTable&) = delete;
+    ObjectTable& operator=(const ObjectTable&) = delete;
+
+    ~ObjectTable() {
+        for (std::size_t d = 0; d < root_size; ++d) {
+            Directory* directory = root[d].load(std::memory_order_relaxed);
+            if (!directory) continue;
+            for (auto& page_slot : directory->pages) {
+                Page* page = page_slot.load(std::memory_order_relaxed);
+                if (!page) continue;
+                for (auto& slot : page->slots) delete slot.load(std::memory_order_relaxed);
+                delete page;
+            }
+            delete directory;
+        }
+    }
+
+    // Whether other threads may read the table while it is changed. Can only be turned on.
+    void set_concurrent() { concurrent.store(true, std::memory_order_relaxed); }
+    bool is_concurrent() const { return concurrent.load(std::memory_order_relaxed); }
+
+    // The object stays valid until it is changed or erased, or while concurrent, until the EpochGuard around the lookup
+    // ends.
+    const T* find(GLuint handle) const {
+        const Page* page = find_page(handle);
+        if (!page) return nullptr;
+        return page->slots[handle & (page_size - 1)].load(std::memory_order_acquire);
+    }
+
+    // Inserts value at handle. Returns the stored object and whether it was inserted, an existing object is left as is.
+    std::pair<const T*, bool> insert(GLuint handle, T value) {
+        std::lock_guard<std::mutex> lock(shard(handle));
+        std::atomic<T*>& slot = get_or_create_page(handle).slots[handle & (page_size - 1)];
+        if (T* existing = slot.load(std::memory_order_relaxed)) {
+            return { existing, false };
+        }
+
+        T* object = new T(std::move(value));
+        slot.store(object, std::memory_order_release);
+        count.fetch_add(1, std::memory_order_relaxed);
+        return { object, true };
+    }
+
+    // Calls f(T&) to change the object at handle. Returns the changed object, or nullptr if there is none.
+    template<typename F>
+    const T* update(GLuint handle, F&& f) {
+        Page* page = find_page(handle);
+        if (!page) return nullptr;
+
+        std::lock_guard<std::mutex> lock(shard(handle));
+        std::atomic<T*>& slot = page->slots[handle & (page_size - 1)];
+        T* current = slot.load(std::memory_order_relaxed);
+        if (!current) return nullptr;
+
+        if (!is_concurrent()) {
+            f(*current);
+            changes.fetch_add(1, std::memory_order_release);
+            return current;
+        }
+
+        T* copy = new T(*current);
+        f(*copy);
+        slot.store(copy, std::memory_order_release);
+        changes.fetch_add(1, std::memory_order_release);
+        retire(current);
+        return copy;
+    }
+
+    // Calls f(const T&) with the object at handle right before it is removed.
+    template<typename F>
+    bool erase(GLuint handle, F&& f) {
+        Page* page = find_page(handle);
+        if (!page) return false;
+
+        std::lock_guard<std::mutex> lock(shard(handle));
+        T* object = page->slots[handle & (page_size - 1)].exchange(nullptr, std::memory_order_acq_rel);
+        if (!object) return false;
+
+        f(static_cast<const T&>(*object));
+        count.fetch_sub(1, std::memory_order_relaxed);
+        changes.fetch_add(1, std::memory_order_release);
+        if (is_concurrent()) {
+            retire(object);
+        } else {
+            delete object;
+        }
+        return true;
+    }
+
+    bool erase(GLuint handle) {
+        return erase(handle, [](const T&) {});
+    }
+
+    template<typename F>
+    void for_each(F&& f) const {
+        for (std::size_t d = 0; d < root_size; ++d) {
+            const Directory* directory = root[d].load(std::memory_order_acquire);
+            if (!directory) continue;
+            for (const auto& page_slot : directory->pages) {
+                const Page* page = page_slot.load(std::memory_order_acquire);
+                if (!page) continue;
+                for (const auto& slot : page->slots) {
+                    if (const T* object = slot.load(std::memory_order_acquire)) f(*object);
+                }
+            }
+        }
+    }
+
+    std::size_t size() const { return count.load(std::memory_order_relaxed); }
+
+    // Counts updates and erases, so results derived from objects can be cached until one of them changes. Read it
+    // before the lookups the result is derived from: it is bumped after the change is visible.
+    std::uint64_t changes_count() const { return changes.load(std::memory_order_acquire); }
+
+    // Bytes allocated by the table, including unused slots in partially filled pages.
+    std::size_t memory_usage() const {
+        std::size_t bytes = root_size * sizeof(std::atomic<Directory*>) + size() * sizeof(T);
+        for (std::size_t d = 0; d < root_size; ++d) {
+            const Directory* directory = root[d].load(std::memory_order_relaxed);
+            if (!directory) continue;
+            bytes += sizeof(Directory);
+            for (const auto& page_slot : directory->pages) {
+                if (page_slot.load(std::memory_order_relaxed)) bytes += sizeof(Page);
+            }
+        }
+        return bytes;
+    }
+
+private:
+    struct Page {
+        std::atomic<T*> slots[page_size];
+    };
+
+    struct Directory {
+        std::atomic<Page*> pages[directory_size];
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+    };
+
+    Page* find_page(GLuint handle) const {
+        const Directory* directory = root[handle >> (page_bits + directory_bits)].load(std::memory_order_acquire);
+        if (!directory) return nullptr;
+        return directory->pages[(handle >> page_bits) & (directory_size - 1)].load(std::memory_order_acquire);
+    }
+
+    // Installs a zeroed node with a compare and swap, the loser of a race frees its own.
+    template<typename Node>
+    static Node& get_or_create(std::atomic<Node*>& slot) {
+        Node* node = slot.load(std::memory_order_acquire);
+        if (node) return *node;
+
+        auto* fresh = new Node();
+        if (slot.compare_exchange_strong(node, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return *fresh;
+        }
+        delete fresh;
+        return *node;
+    }
+
+    Page& get_or_create_page(GLuint handle) {
+        Directory& directory = get_or_create(root[handle >> (page_bits + directory_bits)]);
+        return get_or_create(directory.pages[(handle >> page_bits) & (directory_size - 1)]);
+    }
+
+    std::mutex& shard(GLuint handle) { return shards[handle % shard_count].mutex; }
+
+    std::unique_ptr<std::atomic<Directory*>[]> root;
+    Shard shards[shard_count];
+    std::atomic<std::size_t> count{ 0 };
+    std::atomic<std::uint64_t> changes{ 0 };
+    std::atomic<bool> concurrent{ false };
+};
+
+}
+
+#endif
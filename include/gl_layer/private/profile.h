@@ -0,0 +1,37 @@
+#ifndef GL_VALIDATION_LAYER_PROFILE_H_
+#define GL_VALIDATION_LAYER_PROFILE_H_
+
+#include <gl_layer/context.h>
+
+#include <cstdint>
+
+// Validation profile the library is built with, selected by the GL_VALIDATION_LAYER_PROFILE CMake option. Rules that
+// are not part of the profile are compiled out, the runtime rule mask can only select from the remaining ones.
+#define GL_LAYER_PROFILE_OFF 0
+#define GL_LAYER_PROFILE_MINIMAL 1
+#define GL_LAYER_PROFILE_FULL 2
+
+#ifndef GL_LAYER_PROFILE
+#define GL_LAYER_PROFILE GL_LAYER_PROFILE_FULL
+#endif
+
+namespace gl_layer {
+
+// GLLayerRule flags of the rules compiled into this build. The minimal profile keeps the object status checks, and
+// leaves out everything that validates state on every call.
+constexpr std::uint32_t compiled_rules =
+#if GL_LAYER_PROFILE == GL_LAYER_PROFILE_OFF
+  GL_LAYER_RULE_NONE;
+#elif GL_LAYER_PROFILE == GL_LAYER_PROFILE_MINIMAL
+  GL_LAYER_RULE_SHADER_COMPILE | GL_LAYER_RULE_PROGRAM_LINK;
+#else
+  GL_LAYER_RULE_ALL;
+#endif
+
+constexpr bool rule_compiled(std::uint32_t rule) {
+    return (compiled_rules & rule) != 0;
+}
+
+}
+
+#endif
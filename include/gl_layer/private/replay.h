@@ -0,0 +1,64 @@
+#ifndef GL_VALIDATION_LAYER_REPLAY_H_
+#define GL_VALIDATION_LAYER_REPLAY_H_
+
+#include <gl_layer/context.h>
+#include <gl_layer/private/context.h>
+#include <gl_layer/private/trace.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace gl_layer {
+
+// Validates the calls of a recorded trace without an OpenGL driver, by passing them to a context like the application
+// made them. The context must be created with gl_functions(), which answer the driver queries of uniform reflection
+// with the results recorded in the trace. Programs are matched to those results by handle and by how often they were
+// linked before, since the replay may reflect a program at another point than the recording did.
+class TraceReplay {
+public:
+    struct Stats {
+        std::uint64_t calls = 0;
+        std::uint64_t frames = 0;
+        // Calls that read an array that was too large to record.
+        std::uint64_t skipped_calls = 0;
+        // Reflections of programs the trace has no recorded results for, those are reported to have no uniforms.
+        std::uint64_t missing_reflections = 0;
+    };
+
+    explicit TraceReplay(const TraceReader& reader);
+
+    static const ContextGLFunctions& gl_functions();
+
+    // Passes every recorded call to context. Returns false if the trace ends in a damaged record, the calls before it
+    // were still replayed.
+    bool run(Context& context);
+
+    const Stats& stats() const { return replay_stats; }
+
+private:
+    // Recorded reflection results are looked up by program and link count.
+    static std::uint64_t reflection_key(GLuint program, std::uint32_t links) {
+        return (static_cast<std::uint64_t>(program) << 32) | links;
+    }
+
+    const std::vector<TraceUniform>* current_uniforms(GLuint program);
+    void replay_call(Context& context, const TraceRecord& record);
+
+    static void get_active_uniform(GLuint program, GLuint index, GLsizei buf_size, GLsizei* length, GLint* size, GLenum* type,
+                                   GLchar* name);
+    static GLint get_uniform_location(GLuint program, const GLchar* name);
+    static void get_programiv(GLuint program, GLenum pname, GLint* params);
+
+    const TraceReader& reader;
+    std::unordered_map<std::uint64_t, std::vector<TraceUniform>> reflections{};
+    // Links of each program replayed so far.
+    std::unordered_map<GLuint, std::uint32_t> links{};
+    // Arrays are copied here before they are passed on, records in the trace are not aligned.
+    std::vector<std::uint32_t> array_buffer{};
+    Stats replay_stats{};
+};
+
+}
+
+#endif
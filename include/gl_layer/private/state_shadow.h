@@ -0,0 +1,200 @@
+#ifndef GL_VALIDATION_LAYER_STATE_SHADOW_H_
+#define GL_VALIDATION_LAYER_STATE_SHADOW_H_
+
+#include <gl_layer/private/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gl_layer {
+
+// Copy of the bind and enable state of one context, to find calls that set state to the value it already has. The layer
+// may be attached after the application changed state, so every value starts out unknown, and the first call that sets
+// it is never redundant. The vertex array binding and the active texture unit are the exceptions, they start out as 0,
+// like in a new context: draws need to know the vertex array, and most applications never leave texture unit 0.
+// Capabilities are two bitsets, bindings small arrays indexed by target.
+//
+// Every setter returns true if the call was redundant.
+class StateShadow {
+public:
+    static constexpr GLuint unknown = ~GLuint{ 0 };
+    static constexpr std::size_t texture_unit_count = 32;
+
+    StateShadow() {
+        reset();
+        vertex_array = 0;
+        active_unit = 0;
+    }
+
+    void reset() {
+        enabled_caps = 0;
+        known_caps = 0;
+        active_unit = unknown;
+        vertex_array = unknown;
+        for (GLuint& buffer : buffers) buffer = unknown;
+        for (auto& unit : textures) {
+            for (GLuint& texture : unit) texture = unknown;
+        }
+        blend_src = unknown;
+        blend_dst = unknown;
+        depth_func = unknown;
+    }
+
+    bool set_enabled(GLenum cap, bool enabled) {
+        int index = capability_index(cap);
+        if (index < 0) return false;
+
+        std::uint32_t bit = std::uint32_t{ 1 } << index;
+        bool redundant = (known_caps & bit) && ((enabled_caps & bit) != 0) == enabled;
+        known_caps |= bit;
+        enabled_caps = enabled ? enabled_caps | bit : enabled_caps & ~bit;
+        return redundant;
+    }
+
+    bool bind_buffer(GLenum target, GLuint buffer) {
+        int index = buffer_target_index(target);
+        return index >= 0 && set(buffers[index], buffer);
+    }
+
+    // The element array buffer binding belongs to the vertex array object, it is unknown again after switching VAOs.
+    bool bind_vertex_array(GLuint array) {
+        if (set(vertex_array, array)) return true;
+        buffers[element_array_buffer_index] = unknown;
+        return false;
+    }
+
+    bool active_texture(GLenum texture) {
+        return set(active_unit, texture - GL_TEXTURE0);
+    }
+
+    bool bind_texture(GLenum target, GLuint texture) {
+        int index = texture_target_index(target);
+        if (index < 0 || active_unit >= texture_unit_count) return false;
+        return set(textures[active_unit][index], texture);
+    }
+
+    bool blend_func(GLenum src, GLenum dst) {
+        bool redundant = blend_src == src && blend_dst == dst;
+        blend_src = src;
+        blend_dst = dst;
+        return redundant;
+    }
+
+    bool set_depth_func(GLenum func) { return set(depth_func, func); }
+
+    // Deleting an object unbinds it everywhere it is bound in the current context.
+    void delete_buffer(GLuint buffer) {
+        for (GLuint& bound : buffers) {
+            if (bound == buffer) bound = 0;
+        }
+    }
+
+    void delete_texture(GLuint texture) {
+        for (auto& unit : textures) {
+            for (GLuint& bound : unit) {
+                if (bound == texture) bound = 0;
+            }
+        }
+    }
+
+    // Returns true if the array was bound.
+    bool delete_vertex_array(GLuint array) {
+        if (vertex_array != array) return false;
+        bind_vertex_array(0);
+        return true;
+    }
+
+    GLuint bound_vertex_array() const { return vertex_array; }
+    GLuint active_texture_unit() const { return active_unit; }
+
+private:
+    static bool set(GLuint& slot, GLuint value) {
+        bool redundant = slot == value;
+        slot = value;
+        return redundant;
+    }
+
+    // Capabilities of glEnable and glDisable that are tracked, others are never reported as redundant.
+    static int capability_index(GLenum cap) {
+        switch (cap) {
+            case GL_BLEND: return 0;
+            case GL_CULL_FACE: return 1;
+            case GL_DEPTH_TEST: return 2;
+            case GL_STENCIL_TEST: return 3;
+            case GL_SCISSOR_TEST: return 4;
+            case GL_DITHER: return 5;
+            case GL_POLYGON_OFFSET_FILL: return 6;
+            case GL_POLYGON_OFFSET_LINE: return 7;
+            case GL_MULTISAMPLE: return 8;
+            case GL_SAMPLE_ALPHA_TO_COVERAGE: return 9;
+            case GL_SAMPLE_COVERAGE: return 10;
+            case GL_RASTERIZER_DISCARD: return 11;
+            case GL_PRIMITIVE_RESTART: return 12;
+            case GL_PRIMITIVE_RESTART_FIXED_INDEX: return 13;
+            case GL_FRAMEBUFFER_SRGB: return 14;
+            case GL_DEPTH_CLAMP: return 15;
+            case GL_PROGRAM_POINT_SIZE: return 16;
+            case GL_TEXTURE_CUBE_MAP_SEAMLESS: return 17;
+            case GL_LINE_SMOOTH: return 18;
+            case GL_DEBUG_OUTPUT: return 19;
+            case GL_DEBUG_OUTPUT_SYNCHRONOUS: return 20;
+            default: return -1;
+        }
+    }
+
+    static constexpr int element_array_buffer_index = 1;
+
+    static int buffer_target_index(GLenum target) {
+        switch (target) {
+            case GL_ARRAY_BUFFER: return 0;
+            case GL_ELEMENT_ARRAY_BUFFER: return element_array_buffer_index;
+            case GL_PIXEL_PACK_BUFFER: return 2;
+            case GL_PIXEL_UNPACK_BUFFER: return 3;
+            case GL_UNIFORM_BUFFER: return 4;
+            case GL_TEXTURE_BUFFER: return 5;
+            case GL_TRANSFORM_FEEDBACK_BUFFER: return 6;
+            case GL_COPY_READ_BUFFER: return 7;
+            case GL_COPY_WRITE_BUFFER: return 8;
+            case GL_DRAW_INDIRECT_BUFFER: return 9;
+            case GL_SHADER_STORAGE_BUFFER: return 10;
+            case GL_DISPATCH_INDIRECT_BUFFER: return 11;
+            case GL_QUERY_BUFFER: return 12;
+            case GL_ATOMIC_COUNTER_BUFFER: return 13;
+            default: return -1;
+        }
+    }
+
+    static int texture_target_index(GLenum target) {
+        switch (target) {
+            case GL_TEXTURE_1D: return 0;
+            case GL_TEXTURE_2D: return 1;
+            case GL_TEXTURE_3D: return 2;
+            case GL_TEXTURE_1D_ARRAY: return 3;
+            case GL_TEXTURE_2D_ARRAY: return 4;
+            case GL_TEXTURE_RECTANGLE: return 5;
+            case GL_TEXTURE_CUBE_MAP: return 6;
+            case GL_TEXTURE_CUBE_MAP_ARRAY: return 7;
+            case GL_TEXTURE_BUFFER: return 8;
+            case GL_TEXTURE_2D_MULTISAMPLE: return 9;
+            case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return 10;
+            default: return -1;
+        }
+    }
+
+    static constexpr std::size_t buffer_target_count = 14;
+    static constexpr std::size_t texture_target_count = 11;
+
+    std::uint32_t enabled_caps;
+    std::uint32_t known_caps;
+    GLuint active_unit;
+    GLuint vertex_array;
+    GLuint buffers[buffer_target_count];
+    GLuint textures[texture_unit_count][texture_target_count];
+    GLenum blend_src;
+    GLenum blend_dst;
+    GLenum depth_func;
+};
+
+}
+
+#endif
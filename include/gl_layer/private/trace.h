@@ -0,0 +1,381 @@
+#ifndef GL_VALIDATION_LAYER_TRACE_H_
+#define GL_VALIDATION_LAYER_TRACE_H_
+
+#include <gl_layer/private/entry_points.h>
+#include <gl_layer/private/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Call traces: every call to a validated OpenGL function, with its arguments, recorded into a file that is mapped into
+// memory and used as a ring buffer.
+//
+// The file starts with a TraceFileHeader, followed by blocks of trace_block_size bytes. Each block starts with a
+// TraceBlockHeader and holds whole records. A record is a tag byte, the entry point id for calls, followed by one
+// varint per parameter and, for functions that read an array, a varint byte count and the array. Parameters are stored
+// as the zigzag encoded difference to the same parameter of the previous call to the function in the block, floats as
+// their 32 bit pattern. Every block starts with all previous values at 0, so blocks can be decoded on their own once
+// older ones were overwritten.
+//
+// The used size of a block is only updated after a record is complete, and the mapping is shared with the file, so the
+// file holds every call up to the last one even if the process crashes.
+//
+// Besides the calls, a trace holds what the driver answered when the layer reflected the uniforms of a program, so a
+// replay can answer the same queries without a driver.
+
+namespace gl_layer {
+
+constexpr char trace_magic[8] = { 'G', 'L', 'L', 'T', 'R', 'A', 'C', 'E' };
+constexpr std::uint32_t trace_version = 2;
+constexpr std::size_t trace_header_size = 64;
+constexpr std::size_t trace_block_size = 64 * 1024;
+
+struct TraceFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t block_size;
+    std::uint64_t block_count;
+    // Version of the context the calls were made on.
+    std::uint32_t gl_version_major;
+    std::uint32_t gl_version_minor;
+};
+
+static_assert(sizeof(TraceFileHeader) <= trace_header_size, "Header does not fit");
+
+struct TraceBlockHeader {
+    // Blocks are written in sequence order, starting at 1. 0 for blocks that were never written.
+    std::uint64_t sequence;
+    // Bytes of records after the header.
+    std::uint32_t used;
+    std::uint32_t reserved;
+};
+
+// Records other than calls use the tags above the entry point ids.
+enum class TraceTag : std::uint8_t {
+    // The program handle as a varint, then a varint byte count and the active uniforms as TraceUniform.
+    ProgramUniforms = 0xFE,
+    EndFrame = 0xFF,
+};
+
+// An active uniform of a program, as the driver reported it.
+struct TraceUniform {
+    std::int32_t location;
+    std::int32_t array_size;
+    std::uint32_t type;
+};
+
+static_assert(entry_point_count < 0xF0, "Entry point ids must fit the tag byte");
+
+// Number of 32 bit values the last parameter of a call points to, for the functions that read or return an array: the
+// queried value of glGet*iv, the names of glDelete*, and the values of glUniform*v. 0 for every other function.
+constexpr std::size_t trace_array_values(EntryPoint ep, const std::uint64_t* args) {
+    auto count = [](std::uint64_t arg) -> std::size_t {
+        auto value = static_cast<std::int64_t>(arg);
+        return value > 0 ? static_cast<std::size_t>(value) : 0;
+    };
+
+    switch (ep) {
+        case EntryPoint::glGetShaderiv:
+        case EntryPoint::glGetProgramiv:
+            return 1;
+        case EntryPoint::glDeleteTextures:
+        case EntryPoint::glDeleteBuffers:
+        case EntryPoint::glDeleteVertexArrays:
+            return count(args[0]);
+        case EntryPoint::glUniform1fv:
+        case EntryPoint::glUniform1iv:
+        case EntryPoint::glUniform1uiv:
+            return count(args[1]);
+        case EntryPoint::glUniform2fv:
+        case EntryPoint::glUniform2iv:
+        case EntryPoint::glUniform2uiv:
+            return count(args[1]) * 2;
+        case EntryPoint::glUniform3fv:
+        case EntryPoint::glUniform3iv:
+        case EntryPoint::glUniform3uiv:
+            return count(args[1]) * 3;
+        case EntryPoint::glUniform4fv:
+        case EntryPoint::glUniform4iv:
+        case EntryPoint::glUniform4uiv:
+        case EntryPoint::glUniformMatrix2fv:
+            return count(args[1]) * 4;
+        case EntryPoint::glUniformMatrix2x3fv:
+        case EntryPoint::glUniformMatrix3x2fv:
+            return count(args[1]) * 6;
+        case EntryPoint::glUniformMatrix2x4fv:
+        case EntryPoint::glUniformMatrix4x2fv:
+            return count(args[1]) * 8;
+        case EntryPoint::glUniformMatrix3fv:
+            return count(args[1]) * 9;
+        case EntryPoint::glUniformMatrix3x4fv:
+        case EntryPoint::glUniformMatrix4x3fv:
+            return count(args[1]) * 12;
+        case EntryPoint::glUniformMatrix4fv:
+            return count(args[1]) * 16;
+        case EntryPoint::glProgramUniform1fv:
+        case EntryPoint::glProgramUniform1iv:
+        case EntryPoint::glProgramUniform1uiv:
+            return count(args[2]);
+        case EntryPoint::glProgramUniform2fv:
+        case EntryPoint::glProgramUniform2iv:
+        case EntryPoint::glProgramUniform2uiv:
+            return count(args[2]) * 2;
+        case EntryPoint::glProgramUniform3fv:
+        case EntryPoint::glProgramUniform3iv:
+        case EntryPoint::glProgramUniform3uiv:
+            return count(args[2]) * 3;
+        case EntryPoint::glProgramUniform4fv:
+        case EntryPoint::glProgramUniform4iv:
+        case EntryPoint::glProgramUniform4uiv:
+        case EntryPoint::glProgramUniformMatrix2fv:
+            return count(args[2]) * 4;
+        case EntryPoint::glProgramUniformMatrix2x3fv:
+        case EntryPoint::glProgramUniformMatrix3x2fv:
+            return count(args[2]) * 6;
+        case EntryPoint::glProgramUniformMatrix2x4fv:
+        case EntryPoint::glProgramUniformMatrix4x2fv:
+            return count(args[2]) * 8;
+        case EntryPoint::glProgramUniformMatrix3fv:
+            return count(args[2]) * 9;
+        case EntryPoint::glProgramUniformMatrix3x4fv:
+        case EntryPoint::glProgramUniformMatrix4x3fv:
+            return count(args[2]) * 12;
+        case EntryPoint::glProgramUniformMatrix4fv:
+            return count(args[2]) * 16;
+        default:
+            return 0;
+    }
+}
+
+// Arguments as stored in a trace. Unlike message arguments, floats keep their 32 bit pattern, so they delta encode well.
+template<typename T>
+std::uint64_t to_trace_arg(T value) {
+    if constexpr (std::is_pointer_v<T>) {
+        return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        auto as_float = static_cast<float>(value);
+        std::uint32_t bits;
+        std::memcpy(&bits, &as_float, sizeof(bits));
+        return bits;
+    } else if constexpr (std::is_signed_v<T>) {
+        return static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+    } else {
+        return static_cast<std::uint64_t>(value);
+    }
+}
+
+template<typename T>
+T from_trace_arg(std::uint64_t raw) {
+    if constexpr (std::is_pointer_v<T>) {
+        return reinterpret_cast<T>(static_cast<std::uintptr_t>(raw));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        auto bits = static_cast<std::uint32_t>(raw);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return static_cast<T>(value);
+    } else {
+        return static_cast<T>(raw);
+    }
+}
+
+// Appends calls to a trace file. Recording a call only writes to the mapped file, it makes no system calls and does
+// not allocate. Not thread safe, each context records to its own file.
+class TraceWriter {
+public:
+    // Creates or overwrites the file at path, with size rounded up to whole blocks. Returns null if the file could not
+    // be created or mapped.
+    static std::unique_ptr<TraceWriter> create(const char* path, std::uint64_t size, Version gl_version);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    template<EntryPoint EP, typename... Args>
+    void record(Args... args) {
+        constexpr std::size_t arg_count = sizeof...(Args);
+        static_assert(arg_count == entry_point_param_count(EP), "Arguments do not match the entry point");
+        const std::uint64_t raw[arg_count] = { to_trace_arg(args)... };
+
+        // Arrays that do not fit a block are left out, the byte count is 0 then.
+        std::size_t array_values = trace_array_values(EP, raw);
+        const void* array = reinterpret_cast<const void*>(static_cast<std::uintptr_t>(raw[arg_count - 1]));
+        std::size_t array_bytes = array && array_values <= max_array_bytes / 4 ? array_values * 4 : 0;
+
+        unsigned char* out = begin_record(1 + (arg_count + 1) * max_varint_size + array_bytes);
+        *out++ = static_cast<unsigned char>(EP);
+        std::uint64_t* last = last_args[static_cast<std::size_t>(EP)];
+        for (std::size_t i = 0; i < arg_count; ++i) {
+            auto delta = static_cast<std::int64_t>(raw[i] - last[i]);
+            out = write_varint(out, (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63));
+            last[i] = raw[i];
+        }
+        if (array_values > 0) {
+            out = write_varint(out, array_bytes);
+            std::memcpy(out, array, array_bytes);
+            out += array_bytes;
+        }
+        end_record(out);
+    }
+
+    // Programs with more uniforms than fit a block are recorded with the ones that fit.
+    void record_program_uniforms(std::uint32_t program, const TraceUniform* uniforms, std::size_t count) {
+        std::size_t bytes = std::min(count, max_array_bytes / sizeof(TraceUniform)) * sizeof(TraceUniform);
+        unsigned char* out = begin_record(1 + 2 * max_varint_size + bytes);
+        *out++ = static_cast<unsigned char>(TraceTag::ProgramUniforms);
+        out = write_varint(out, program);
+        out = write_varint(out, bytes);
+        std::memcpy(out, uniforms, bytes);
+        end_record(out + bytes);
+    }
+
+    void record_end_frame() {
+        unsigned char* out = begin_record(1);
+        *out++ = static_cast<unsigned char>(TraceTag::EndFrame);
+        end_record(out);
+    }
+
+private:
+    static constexpr std::size_t max_varint_size = 10;
+    static constexpr std::size_t max_array_bytes =
+      trace_block_size - sizeof(TraceBlockHeader) - 1 - (max_entry_point_params + 1) * max_varint_size;
+
+    TraceWriter() = default;
+
+    static unsigned char* write_varint(unsigned char* out, std::uint64_t value) {
+        while (value >= 0x80) {
+            *out++ = static_cast<unsigned char>(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<unsigned char>(value);
+        return out;
+    }
+
+    // Returns where to write a record of at most max_size bytes, moving on to the next block if it does not fit.
+    unsigned char* begin_record(std::size_t max_size) {
+        if (max_size > static_cast<std::size_t>(block_end - position)) next_block();
+        return position;
+    }
+
+    // Publishes the record. The used size is written after the record, and the compiler may not reorder the two, so a
+    // crash never leaves a partial record in the file.
+    void end_record(unsigned char* end) {
+        position = end;
+        std::atomic_signal_fence(std::memory_order_release);
+        auto used = static_cast<std::uint32_t>(position - block - sizeof(TraceBlockHeader));
+        std::memcpy(block + offsetof(TraceBlockHeader, used), &used, sizeof(used));
+    }
+
+    // Starts the next block, overwriting the oldest one once the file is full.
+    void next_block();
+
+    unsigned char* mapping = nullptr;
+    std::size_t mapping_size = 0;
+    std::uint64_t block_count = 0;
+    std::uint64_t sequence = 0;
+    unsigned char* block = nullptr;
+    unsigned char* position = nullptr;
+    unsigned char* block_end = nullptr;
+    std::uint64_t last_args[entry_point_count][max_entry_point_params] = {};
+#ifdef _WIN32
+    void* file = nullptr;
+    void* file_mapping = nullptr;
+#endif
+};
+
+// A record read back from a trace. For calls, args holds the parameters as they were passed, floats as their 32 bit
+// pattern. Pointer parameters keep the address they had in the recording process, only array points into the trace.
+// For ProgramUniforms records, args[0] is the program and array holds the uniforms.
+struct TraceRecord {
+    std::uint8_t tag;
+    EntryPoint entry_point;
+    std::uint64_t args[max_entry_point_params];
+    const unsigned char* array;
+    std::size_t array_bytes;
+};
+
+// Reads a trace file written by TraceWriter, oldest record first.
+class TraceReader {
+public:
+    // Returns false if the file could not be read or is not a trace.
+    bool open(const char* path);
+
+    Version gl_version() const { return version; }
+    // Whether older calls were overwritten, the trace then starts in the middle of the application's run.
+    bool wrapped() const { return first_sequence > 1; }
+
+    // Calls f(const TraceRecord&) for every record. Returns false if the trace ends in a damaged record.
+    template<typename F>
+    bool for_each(F&& f) const {
+        for (std::size_t offset : block_offsets) {
+            TraceBlockHeader header;
+            std::memcpy(&header, data.data() + offset, sizeof(header));
+            const unsigned char* in = data.data() + offset + sizeof(TraceBlockHeader);
+            const unsigned char* end = in + header.used;
+
+            std::uint64_t last_args[entry_point_count][max_entry_point_params] = {};
+            while (in < end) {
+                TraceRecord record{};
+                record.tag = *in++;
+                record.entry_point = EntryPoint::Unknown;
+                if (record.tag < entry_point_count) {
+                    record.entry_point = static_cast<EntryPoint>(record.tag);
+                    std::uint64_t* last = last_args[record.tag];
+                    std::size_t arg_count = entry_point_param_count(record.entry_point);
+                    for (std::size_t i = 0; i < arg_count; ++i) {
+                        std::uint64_t zigzag;
+                        if (!read_varint(in, end, zigzag)) return false;
+                        last[i] += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+                        record.args[i] = last[i];
+                    }
+                    if (trace_array_values(record.entry_point, record.args) > 0) {
+                        std::uint64_t bytes;
+                        if (!read_varint(in, end, bytes) || bytes > static_cast<std::uint64_t>(end - in)) return false;
+                        record.array = in;
+                        record.array_bytes = static_cast<std::size_t>(bytes);
+                        in += bytes;
+                    }
+                } else if (record.tag == static_cast<std::uint8_t>(TraceTag::ProgramUniforms)) {
+                    std::uint64_t bytes;
+                    if (!read_varint(in, end, record.args[0]) || !read_varint(in, end, bytes) ||
+                        bytes > static_cast<std::uint64_t>(end - in)) {
+                        return false;
+                    }
+                    record.array = in;
+                    record.array_bytes = static_cast<std::size_t>(bytes);
+                    in += bytes;
+                } else if (record.tag != static_cast<std::uint8_t>(TraceTag::EndFrame)) {
+                    return false;
+                }
+                f(static_cast<const TraceRecord&>(record));
+            }
+        }
+        return true;
+    }
+
+private:
+    static bool read_varint(const unsigned char*& in, const unsigned char* end, std::uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; in < end && shift < 64; shift += 7) {
+            unsigned char byte = *in++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    std::vector<unsigned char> data{};
+    // Offsets of the written blocks in data, in the order they were written.
+    std::vector<std::size_t> block_offsets{};
+    std::uint64_t first_sequence = 0;
+    Version version{};
+};
+
+}
+
+#endif
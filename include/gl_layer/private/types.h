@@ -1,9 +1,16 @@
 #ifndef GL_VALIDATION_LAYER_TYPES_H_
 #define GL_VALIDATION_LAYER_TYPES_H_
 
+#include <gl_layer/private/bitset_pool.h>
+
 #include <vector>
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 namespace gl_layer {
 
@@ -13,7 +20,9 @@ using GLint = std::int32_t;
 using GLsizei = std::int32_t;
 using GLchar = char;
 using GLfloat = float;
-using GLboolean = bool;
+using GLboolean = unsigned char;
+using GLintptr = std::ptrdiff_t;
+using GLsizeiptr = std::ptrdiff_t;
 
 enum GLShaderInfoParam {
     GL_SHADER_TYPE = 0x8B4F,
@@ -23,7 +32,63 @@ enum GLShaderInfoParam {
     GL_INFO_LOG_LENGTH = 0x8B84,
     GL_SHADER_SOURCE_LENGTH = 0x8B88,
     GL_ACTIVE_UNIFORM_MAX_LENGTH = 0x8B87,
-    GL_ACTIVE_UNIFORMS = 0x8B86
+    GL_ACTIVE_UNIFORMS = 0x8B86,
+    // KHR_parallel_shader_compile
+    GL_COMPLETION_STATUS_KHR = 0x91B1
+};
+
+// Targets and capabilities of the state tracked by StateShadow.
+enum GLStateParam {
+    GL_BLEND = 0x0BE2,
+    GL_CULL_FACE = 0x0B44,
+    GL_DEPTH_TEST = 0x0B71,
+    GL_STENCIL_TEST = 0x0B90,
+    GL_SCISSOR_TEST = 0x0C11,
+    GL_DITHER = 0x0BD0,
+    GL_POLYGON_OFFSET_FILL = 0x8037,
+    GL_POLYGON_OFFSET_LINE = 0x2A02,
+    GL_MULTISAMPLE = 0x809D,
+    GL_SAMPLE_ALPHA_TO_COVERAGE = 0x809E,
+    GL_SAMPLE_COVERAGE = 0x80A0,
+    GL_RASTERIZER_DISCARD = 0x8C89,
+    GL_PRIMITIVE_RESTART = 0x8F9D,
+    GL_PRIMITIVE_RESTART_FIXED_INDEX = 0x8D69,
+    GL_FRAMEBUFFER_SRGB = 0x8DB9,
+    GL_DEPTH_CLAMP = 0x864F,
+    GL_PROGRAM_POINT_SIZE = 0x8642,
+    GL_TEXTURE_CUBE_MAP_SEAMLESS = 0x884F,
+    GL_LINE_SMOOTH = 0x0B20,
+    GL_DEBUG_OUTPUT = 0x92E0,
+    GL_DEBUG_OUTPUT_SYNCHRONOUS = 0x8242,
+
+    GL_ARRAY_BUFFER = 0x8892,
+    GL_ELEMENT_ARRAY_BUFFER = 0x8893,
+    GL_PIXEL_PACK_BUFFER = 0x88EB,
+    GL_PIXEL_UNPACK_BUFFER = 0x88EC,
+    GL_UNIFORM_BUFFER = 0x8A11,
+    GL_TRANSFORM_FEEDBACK_BUFFER = 0x8C8E,
+    GL_COPY_READ_BUFFER = 0x8F36,
+    GL_COPY_WRITE_BUFFER = 0x8F37,
+    GL_DRAW_INDIRECT_BUFFER = 0x8F3F,
+    GL_SHADER_STORAGE_BUFFER = 0x90D2,
+    GL_DISPATCH_INDIRECT_BUFFER = 0x90EE,
+    GL_QUERY_BUFFER = 0x9192,
+    GL_ATOMIC_COUNTER_BUFFER = 0x92C0,
+
+    GL_TEXTURE_1D = 0x0DE0,
+    GL_TEXTURE_2D = 0x0DE1,
+    GL_TEXTURE_3D = 0x806F,
+    GL_TEXTURE_1D_ARRAY = 0x8C18,
+    GL_TEXTURE_2D_ARRAY = 0x8C1A,
+    GL_TEXTURE_RECTANGLE = 0x84F5,
+    GL_TEXTURE_CUBE_MAP = 0x8513,
+    GL_TEXTURE_CUBE_MAP_ARRAY = 0x9009,
+    // Both a buffer and a texture target.
+    GL_TEXTURE_BUFFER = 0x8C2A,
+    GL_TEXTURE_2D_MULTISAMPLE = 0x9100,
+    GL_TEXTURE_2D_MULTISAMPLE_ARRAY = 0x9102,
+
+    GL_TEXTURE0 = 0x84C0
 };
 
 enum class CompileStatus {
@@ -45,14 +110,338 @@ struct Version {
     unsigned int minor = 0;
 };
 
+// Types of uniforms that glUniform functions set, and of the uniforms themselves.
+enum GLUniformType {
+    GL_INT = 0x1404,
+    GL_UNSIGNED_INT = 0x1405,
+    GL_FLOAT = 0x1406,
+    GL_FLOAT_VEC2 = 0x8B50,
+    GL_FLOAT_VEC3 = 0x8B51,
+    GL_FLOAT_VEC4 = 0x8B52,
+    GL_INT_VEC2 = 0x8B53,
+    GL_INT_VEC3 = 0x8B54,
+    GL_INT_VEC4 = 0x8B55,
+    GL_BOOL = 0x8B56,
+    GL_BOOL_VEC2 = 0x8B57,
+    GL_BOOL_VEC3 = 0x8B58,
+    GL_BOOL_VEC4 = 0x8B59,
+    GL_FLOAT_MAT2 = 0x8B5A,
+    GL_FLOAT_MAT3 = 0x8B5B,
+    GL_FLOAT_MAT4 = 0x8B5C,
+    GL_FLOAT_MAT2x3 = 0x8B65,
+    GL_FLOAT_MAT2x4 = 0x8B66,
+    GL_FLOAT_MAT3x2 = 0x8B67,
+    GL_FLOAT_MAT3x4 = 0x8B68,
+    GL_FLOAT_MAT4x2 = 0x8B69,
+    GL_FLOAT_MAT4x3 = 0x8B6A,
+    GL_UNSIGNED_INT_VEC2 = 0x8DC6,
+    GL_UNSIGNED_INT_VEC3 = 0x8DC7,
+    GL_UNSIGNED_INT_VEC4 = 0x8DC8
+};
+
+// Samplers and images are set to texture units and image units. Their default of unit 0 is commonly relied on, so they
+// do not have to be written before drawing.
+constexpr bool is_opaque_uniform_type(GLenum type) {
+    return (type >= 0x8B5D && type <= 0x8B64)     // GL_SAMPLER_1D .. GL_SAMPLER_2D_RECT_SHADOW
+           || (type >= 0x8DC0 && type <= 0x8DC5)  // GL_SAMPLER_1D_ARRAY .. GL_SAMPLER_CUBE_SHADOW
+           || (type >= 0x8DC9 && type <= 0x8DD8)  // GL_INT_SAMPLER_1D .. GL_UNSIGNED_INT_SAMPLER_BUFFER
+           || (type >= 0x900C && type <= 0x900F)  // GL_SAMPLER_CUBE_MAP_ARRAY ..
+           || (type >= 0x904C && type <= 0x906C)  // GL_IMAGE_1D .. GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY
+           || (type >= 0x9108 && type <= 0x910D); // GL_SAMPLER_2D_MULTISAMPLE ..
+}
+
+// Number of components of a float, int or unsigned int scalar or vector type, 0 for any other type.
+constexpr int vector_components(GLenum type) {
+    switch (type) {
+        case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: return 1;
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: return 2;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: return 3;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: return 4;
+        default: return 0;
+    }
+}
+
+// Whether a glUniform function that sets values of set_type (GL_FLOAT_VEC3 for glUniform3f) can set a uniform of type.
+// Booleans can be set with the float, int and unsigned int functions of their size, samplers and images only with
+// glUniform1i and glUniform1iv.
+constexpr bool uniform_type_compatible(GLenum set_type, GLenum type) {
+    if (set_type == type) return true;
+    switch (type) {
+        case GL_BOOL: return vector_components(set_type) == 1;
+        case GL_BOOL_VEC2: return vector_components(set_type) == 2;
+        case GL_BOOL_VEC3: return vector_components(set_type) == 3;
+        case GL_BOOL_VEC4: return vector_components(set_type) == 4;
+        default: return set_type == GL_INT && is_opaque_uniform_type(type);
+    }
+}
+
+// Bytes of one value of a uniform type as glUniform uploads it, 0 for types the layer does not know.
+constexpr std::uint32_t uniform_value_size(GLenum type) {
+    switch (type) {
+        case GL_BOOL: return 4;
+        case GL_BOOL_VEC2: return 8;
+        case GL_BOOL_VEC3: return 12;
+        case GL_BOOL_VEC4: return 16;
+        case GL_FLOAT_MAT2: return 16;
+        case GL_FLOAT_MAT3: return 36;
+        case GL_FLOAT_MAT4: return 64;
+        case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: return 24;
+        case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2: return 32;
+        case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3: return 48;
+        default: return is_opaque_uniform_type(type) ? 4 : static_cast<std::uint32_t>(vector_components(type)) * 4;
+    }
+}
+
 struct UniformInfo {
     GLint array_size;
     GLenum type;
     // std::string name // the name is probably not useful for us
+    // True for the locations of the elements of an array after the first, array_size is the number of elements from
+    // this one to the end of the array.
+    bool array_element = false;
+    // Where the value is kept in UniformValues, set by UniformTable::assign.
+    std::uint32_t value_offset = 0;
 
     bool operator==(const UniformInfo& other) const {
-      return array_size == other.array_size && type == other.type;
+      return array_size == other.array_size && type == other.type && array_element == other.array_element;
+    }
+};
+
+// Active uniforms of a program, looked up by location in constant time, since every glUniform call does one lookup.
+// Locations are usually small and contiguous, in which case they index a flat array directly. Programs with sparse
+// locations (e.g. large explicit layout locations) use a hash table with linear probing instead, at most half full.
+class UniformTable {
+public:
+    // Replaces the contents of the table. Entries with a negative location (uniforms in blocks) are ignored.
+    void assign(std::vector<std::pair<GLint, UniformInfo>> entries) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [](const auto& e) { return e.first < 0; }), entries.end());
+        std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        dense.clear();
+        sparse.clear();
+        count = entries.size();
+        value_bytes = 0;
+        if (entries.empty()) return;
+
+        // Values are laid out in order of location, so the elements of an array are next to each other.
+        for (auto& [location, info] : entries) {
+            info.value_offset = value_bytes;
+            value_bytes += uniform_value_size(info.type);
+        }
+
+        std::size_t max_location = static_cast<std::size_t>(entries.back().first);
+        if (max_location < 2 * entries.size() + 16) {
+            dense.resize(max_location + 1, UniformInfo{ 0, 0 });
+            for (const auto& [location, info] : entries) {
+                dense[static_cast<std::size_t>(location)] = info;
+            }
+        } else {
+            sparse_bits = 4;
+            while ((std::size_t{ 1 } << sparse_bits) < 2 * entries.size()) ++sparse_bits;
+            sparse.assign(std::size_t{ 1 } << sparse_bits, SparseEntry{ -1, UniformInfo{ 0, 0 } });
+            std::size_t mask = sparse.size() - 1;
+            for (const auto& [location, info] : entries) {
+                std::size_t slot = slot_of(location);
+                while (sparse[slot].location >= 0) slot = (slot + 1) & mask;
+                sparse[slot] = SparseEntry{ location, info };
+            }
+        }
+    }
+
+    // Returns nullptr if there is no active uniform at this location.
+    const UniformInfo* find(GLint location) const {
+        if (location < 0) return nullptr;
+
+        if (!dense.empty()) {
+            auto index = static_cast<std::size_t>(location);
+            if (index >= dense.size() || dense[index].type == 0) return nullptr;
+            return &dense[index];
+        }
+
+        if (sparse.empty()) return nullptr;
+
+        std::size_t mask = sparse.size() - 1;
+        for (std::size_t slot = slot_of(location);; slot = (slot + 1) & mask) {
+            const SparseEntry& entry = sparse[slot];
+            if (entry.location == location) return &entry.info;
+            if (entry.location < 0) return nullptr;
+        }
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    // Bytes of the values of all uniforms.
+    std::uint32_t value_size() const { return value_bytes; }
+
+    // Calls f(location, info) for every uniform. Dense tables are visited in order of location.
+    template<typename F>
+    void for_each(F&& f) const {
+        for (std::size_t i = 0; i < dense.size(); ++i) {
+            if (dense[i].type != 0) f(static_cast<GLint>(i), dense[i]);
+        }
+        for (const SparseEntry& entry : sparse) {
+            if (entry.location >= 0) f(entry.location, entry.info);
+        }
     }
+
+private:
+    // Empty slots have location -1.
+    struct SparseEntry {
+        GLint location;
+        UniformInfo info;
+    };
+
+    // Fibonacci hashing, the top bits of the product spread out the strided locations of large explicit layouts.
+    std::size_t slot_of(GLint location) const {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(location) * 0x9E3779B97F4A7C15ull) >> (64 - sparse_bits));
+    }
+
+    // Indexed by location, slots without a uniform have type 0.
+    std::vector<UniformInfo> dense {};
+    std::vector<SparseEntry> sparse {};
+    unsigned int sparse_bits = 0;
+    std::size_t count = 0;
+    std::uint32_t value_bytes = 0;
+};
+
+// Which uniform locations of a program were written since it was last linked, and which must be before drawing, as two
+// bitsets with one bit per location in a BitsetPool. Copies of a Program made by ObjectTable::update refer to the same
+// bits, so writing a uniform does not copy the program. Bits are set with atomic ors, since contexts on several threads
+// may use the same program.
+class UniformWrites {
+public:
+    // Allocates the bitsets for the uniforms of a table. Every uniform that is not a sampler or image must be written
+    // before drawing, of an array only the first element, the rest may be unused. Tracks nothing if the pool is full.
+    static UniformWrites create(BitsetPool& pool, const UniformTable& uniforms) {
+        GLint max_location = -1;
+        uniforms.for_each([&max_location](GLint location, const UniformInfo&) { max_location = std::max(max_location, location); });
+
+        UniformWrites writes;
+        auto word_count = static_cast<std::uint32_t>(max_location + 64) / 64;
+        writes.first = pool.allocate(2 * std::size_t{ word_count });
+        if (writes.first == BitsetPool::none) return writes;
+
+        writes.word_count = word_count;
+        std::atomic<std::uint64_t>* required = pool.words(writes.first);
+        uniforms.for_each([required](GLint location, const UniformInfo& info) {
+            if (!is_opaque_uniform_type(info.type) && !info.array_element) {
+                required[location / 64].fetch_or(std::uint64_t{ 1 } << (location % 64), std::memory_order_relaxed);
+            }
+        });
+        return writes;
+    }
+
+    // Returns the bitsets to the pool. With concurrent readers, they are only reused once those are done.
+    void release(BitsetPool& pool, bool concurrent) {
+        if (concurrent) {
+            pool.free_deferred(first, 2 * std::size_t{ word_count });
+        } else {
+            pool.free(first, 2 * std::size_t{ word_count });
+        }
+        *this = UniformWrites{};
+    }
+
+    bool empty() const { return word_count == 0; }
+
+    // Marks count locations starting at location as written. Returns true if any of them was not written before.
+    bool write(const BitsetPool& pool, GLint location, GLsizei count) const {
+        if (location < 0 || count <= 0 || empty()) return false;
+
+        std::atomic<std::uint64_t>* written = pool.words(first) + word_count;
+        bool first_write = false;
+        std::size_t end = std::min(static_cast<std::size_t>(location) + static_cast<std::size_t>(count), std::size_t{ word_count } * 64);
+        for (std::size_t bit = static_cast<std::size_t>(location); bit < end;) {
+            std::size_t word = bit / 64;
+            std::size_t bits = std::min<std::size_t>(end - bit, 64 - bit % 64);
+            std::uint64_t mask = (bits == 64 ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << bits) - 1) << (bit % 64);
+            // Skip the read-modify-write when the bits are set already, which is the common case.
+            if ((written[word].load(std::memory_order_relaxed) & mask) != mask) {
+                first_write |= (written[word].fetch_or(mask, std::memory_order_relaxed) & mask) != mask;
+            }
+            bit += bits;
+        }
+        return first_write;
+    }
+
+    // Returns the lowest location that must be written before drawing but was not, or -1 if there is none.
+    GLint first_unset(const BitsetPool& pool) const {
+        if (empty()) return -1;
+
+        const std::atomic<std::uint64_t>* required = pool.words(first);
+        const std::atomic<std::uint64_t>* written = required + word_count;
+        // Nearly every draw finds nothing unset, so 256 locations are tested at once, and only searched when one is.
+        for (std::size_t block = 0; block < word_count; block += 4) {
+            std::size_t end = std::min<std::size_t>(block + 4, word_count);
+            std::uint64_t any_unset = 0;
+            for (std::size_t i = block; i < end; ++i) {
+                any_unset |= required[i].load(std::memory_order_relaxed) & ~written[i].load(std::memory_order_relaxed);
+            }
+            if (any_unset == 0) continue;
+
+            for (std::size_t i = block; i < end; ++i) {
+                std::uint64_t unset = required[i].load(std::memory_order_relaxed) & ~written[i].load(std::memory_order_relaxed);
+                if (unset != 0) return static_cast<GLint>(i * 64) + lowest_set_bit(unset);
+            }
+        }
+        return -1;
+    }
+
+private:
+    // The required bits, followed by the written bits.
+    std::uint32_t first = BitsetPool::none;
+    std::uint32_t word_count = 0;
+};
+
+// Last values uploaded to the uniforms of a program, to find uploads that change nothing. The values of all uniforms of a
+// program live in one block, at the offsets UniformTable::assign gave them, and are only compared once a value was
+// uploaded to the location. While contexts on several threads may upload to the same program, a spinlock keeps each
+// upload whole.
+class UniformValues {
+public:
+    explicit UniformValues(const UniformTable& uniforms) : values(std::make_unique<unsigned char[]>(uniforms.value_size())) {
+        GLint max_location = -1;
+        uniforms.for_each([&max_location](GLint location, const UniformInfo&) { max_location = std::max(max_location, location); });
+        known.assign(static_cast<std::size_t>(max_location + 64) / 64, 0);
+    }
+
+    // Stores count values of value_size bytes uploaded to the uniform at location. Values past the end of an array are
+    // ignored, like OpenGL does. Returns the bytes uploaded if they were all the same as before, 0 otherwise.
+    std::size_t upload(GLint location, const UniformInfo& info, const void* data, GLsizei count, std::size_t value_size,
+                       bool concurrent) {
+        if (count <= 0 || value_size != uniform_value_size(info.type)) return 0;
+
+        std::size_t elements = std::min<std::size_t>(static_cast<std::size_t>(count), static_cast<std::size_t>(std::max(info.array_size, 1)));
+        std::size_t bytes = elements * value_size;
+        unsigned char* stored = values.get() + info.value_offset;
+
+        if (concurrent) {
+            while (lock.test_and_set(std::memory_order_acquire)) {}
+        }
+        bool redundant = all_known(static_cast<std::size_t>(location), elements) && std::memcmp(stored, data, bytes) == 0;
+        if (!redundant) {
+            std::memcpy(stored, data, bytes);
+            set_known(static_cast<std::size_t>(location), elements);
+        }
+        if (concurrent) lock.clear(std::memory_order_release);
+        return redundant ? bytes : 0;
+    }
+
+private:
+    bool all_known(std::size_t location, std::size_t count) const {
+        for (std::size_t i = location; i < location + count; ++i) {
+            if (!(known[i / 64] & (std::uint64_t{ 1 } << (i % 64)))) return false;
+        }
+        return true;
+    }
+
+    void set_known(std::size_t location, std::size_t count) {
+        for (std::size_t i = location; i < location + count; ++i) known[i / 64] |= std::uint64_t{ 1 } << (i % 64);
+    }
+
+    std::unique_ptr<unsigned char[]> values;
+    // One bit per location that has a value.
+    std::vector<std::uint64_t> known;
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
 };
 
 // Represents a shader returned by glCreateShader
@@ -61,15 +450,28 @@ struct Shader {
     // If this is -1, this means the compile status was never checked by the host application.
     // This is an error that should be reported.
     CompileStatus compile_status = CompileStatus::UNCHECKED;
+    // True from glCompileShader until the application observed the compile finishing, either by polling
+    // GL_COMPLETION_STATUS_KHR or by querying GL_COMPILE_STATUS (which waits for it).
+    bool compile_pending = false;
 };
 
 // Represents a shader program returned by glCreateProgram
 struct Program {
     unsigned int handle {};
     std::vector<unsigned int> shaders {};
-    std::unordered_map<GLint, UniformInfo> uniforms {};
+    UniformTable uniforms {};
+    // Uniforms are reflected the first time the program is used after a link, not in glLinkProgram itself. Querying
+    // the program right after linking would force the driver to finish the link synchronously.
+    bool uniforms_reflected = false;
+    // Allocated when the uniforms are reflected, empty before that.
+    UniformWrites uniform_writes {};
+    // Created when the uniforms are reflected while redundant uniform uploads are looked for, null otherwise. Shared by
+    // the copies of the Program like uniform_writes.
+    std::shared_ptr<UniformValues> uniform_values {};
     // If this is -1, this means the status was never checked by the host application.
     LinkStatus link_status = LinkStatus::UNCHECKED;
+    // Same as Shader::compile_pending, for the last glLinkProgram.
+    bool link_pending = false;
 };
 
 }
@@ -0,0 +1,88 @@
+#include <gl_layer/private/async_output.h>
+
+#include <chrono>
+
+namespace gl_layer {
+
+AsyncOutput::AsyncOutput(std::size_t capacity, GLLayerDropPolicy policy, const MessageSink& sink, MessageDeduplicator* dedup,
+                         std::chrono::milliseconds summary_interval)
+  : queue(capacity), policy(policy), sink(sink), dedup(dedup), summary_interval(summary_interval) {
+    writer = std::thread(&AsyncOutput::writer_main, this);
+}
+
+AsyncOutput::~AsyncOutput() {
+    stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        wake.notify_one();
+    }
+    writer.join();
+}
+
+void AsyncOutput::push(const GLLayerMessage& message) {
+    while (!queue.try_push(message)) {
+        if (policy == GL_LAYER_DROP_NEWEST) {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (policy == GL_LAYER_DROP_OLDEST) {
+            GLLayerMessage oldest;
+            if (queue.try_pop(oldest)) {
+                dropped_count.fetch_add(1, std::memory_order_relaxed);
+                delivered_count.fetch_add(1, std::memory_order_release);
+            }
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    pushed_count.fetch_add(1);
+    if (writer_waiting.load()) {
+        wake.notify_one();
+    }
+}
+
+void AsyncOutput::flush() {
+    // Messages dropped to make room were counted as delivered, so this always terminates.
+    while (delivered_count.load(std::memory_order_acquire) < pushed_count.load(std::memory_order_relaxed)) {
+        std::this_thread::yield();
+    }
+}
+
+void AsyncOutput::writer_main() {
+    GLLayerMessage message;
+    for (;;) {
+        while (queue.try_pop(message)) {
+            deliver_message(sink, message);
+            delivered_count.fetch_add(1, std::memory_order_release);
+        }
+
+        if (stop.load()) {
+            // Producers are gone once stop is set, deliver what is left and exit.
+            while (queue.try_pop(message)) {
+                deliver_message(sink, message);
+                delivered_count.fetch_add(1, std::memory_order_release);
+            }
+            return;
+        }
+
+        // The wait below times out, so this runs at least every 10 ms. If the context is writing summaries itself,
+        // this one is skipped rather than waiting for it, the context may be waiting for room in the queue.
+        if (dedup && dedup->summary_due(summary_interval)) {
+            dedup->drain_suppressed([this](const GLLayerMessage& summary) { deliver_message(sink, summary); }, false);
+        }
+
+        // Producers bump pushed_count before checking writer_waiting, and the writer sets writer_waiting before checking
+        // pushed_count, so one of them always sees the other. The timeout covers a notify that lands between the check
+        // and the wait, since producers do not take the mutex.
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        writer_waiting.store(true);
+        wake.wait_for(lock, std::chrono::milliseconds(10), [this] {
+            return stop.load() || pushed_count.load() > delivered_count.load();
+        });
+        writer_waiting.store(false);
+    }
+}
+
+}
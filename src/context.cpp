@@ -2,10 +2,19 @@
 
 #include <gl_layer/private/types.h>
 #include <gl_layer/private/context.h>
+#include <gl_layer/private/entry_points.h>
 
+#include <algorithm>
+#include <atomic>
+#include <string>
 #include <string_view>
 #include <cstdio>
+#include <cstdlib>
 #include <cstdarg>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 
 namespace gl_layer {
 
@@ -17,6 +26,7 @@ const char* enum_str(GLenum v) {
         case GL_LINK_STATUS: return "GL_LINK_STATUS";
         case GL_INFO_LOG_LENGTH: return "GL_INFO_LOG_LENGTH";
         case GL_SHADER_SOURCE_LENGTH: return "GL_SHADER_SOURCE_LENGTH";
+        case GL_COMPLETION_STATUS_KHR: return "GL_COMPLETION_STATUS_KHR";
         default:
             return "";
     }
@@ -26,88 +36,1035 @@ static void default_output_func(const char* text, void* = nullptr) {
     printf("%s\n", text);
 }
 
-Context::Context(Version version, const ContextGLFunctions* gl_functions) 
-  : gl_version(version), gl(*gl_functions) {
-    output_fun = &default_output_func;
+Context::Context(Version version, const ContextGLFunctions* gl_functions, std::shared_ptr<ShareGroup> group)
+  : gl_version(version), gl(*gl_functions), share_group(group ? std::move(group) : std::make_shared<ShareGroup>()),
+    shaders(share_group->shaders), programs(share_group->programs), uniform_bitsets(*share_group->uniform_bitsets) {
+    share_group->add_context();
+    sink.output_fun = &default_output_func;
+    set_rule_mask(compiled_rules);
+    set_sampling(GL_LAYER_SAMPLE_ALL, 1);
+}
+
+Context::~Context() {
+    // Report whatever was suppressed since the last summary, the async writer (if any) is still alive here. Then stop
+    // the writer before the members are destroyed, it also reads dedup.
+    report_suppressed();
+    async_output.reset();
+    share_group->remove_context();
+}
+
+GLLayerCompileStats Context::get_compile_stats() const {
+    std::lock_guard<std::mutex> lock(share_group->stats_mutex);
+    return share_group->compile_stats;
 }
 
 void Context::set_output_callback(GLLayerOutputFun callback, void* user_data) {
-    output_fun = callback;
-    output_user_data = user_data;
+    sink.output_fun = callback;
+    sink.output_user_data = user_data;
+
+    // The background writer holds on to the callback, restart it so it picks up the new one.
+    if (async_output) {
+        set_async_output(true, async_capacity, async_policy);
+    }
+}
+
+void Context::set_message_callback(GLLayerMessageFun callback, void* user_data) {
+    sink.message_fun = callback;
+    sink.message_user_data = user_data;
+
+    // The background writer holds on to the callback, restart it so it picks up the new one.
+    if (async_output) {
+        set_async_output(true, async_capacity, async_policy);
+    }
+}
+
+void Context::set_async_output(bool enabled, std::size_t capacity, GLLayerDropPolicy policy) {
+    if (async_output) {
+        // Destroying the writer delivers every message still queued.
+        dropped_messages += async_output->dropped();
+        async_output.reset();
+    }
+
+    if (enabled) {
+        async_capacity = capacity;
+        async_policy = policy;
+        async_output = std::make_unique<AsyncOutput>(capacity, policy, sink, dedup_enabled ? &dedup : nullptr, summary_interval);
+    }
+}
+
+void Context::flush_output() {
+    if (async_output) {
+        async_output->flush();
+    }
+}
+
+std::uint64_t Context::dropped_message_count() const {
+    return dropped_messages + (async_output ? async_output->dropped() : 0);
+}
+
+void Context::set_message_dedup(bool enabled, std::chrono::milliseconds interval) {
+    report_suppressed();
+    dedup.clear();
+    dedup_enabled = enabled;
+    summary_interval = interval;
+
+    // The background writer also writes summaries, restart it with the new settings.
+    if (async_output) {
+        set_async_output(true, async_capacity, async_policy);
+    }
+}
+
+void Context::inherit_settings(const Context& other) {
+    sink = other.sink;
+    dedup_enabled = other.dedup_enabled;
+    summary_interval = other.summary_interval;
+    set_rule_mask(other.rule_mask);
+}
+
+void Context::set_rule_mask(std::uint32_t mask) {
+    std::uint32_t previous_mask = rule_mask;
+    rule_mask = mask & compiled_rules;
+    update_entry_point_flags();
+
+    // Programs and state are not tracked while their rules are disabled, they may have changed unnoticed. Forget what
+    // was validated, and which state was set. The vertex array binding and the active texture unit are kept if a rule that
+    // follows them stayed enabled.
+    if (rule_mask != previous_mask) {
+        constexpr std::uint32_t vertex_array_rules = GL_LAYER_RULE_REDUNDANT_STATE | GL_LAYER_RULE_DRAW_STATE;
+        GLuint vertex_array = state.bound_vertex_array();
+        GLuint active_unit = state.active_texture_unit();
+        validated_program = 0;
+        ++draw_state_epoch;
+        state.reset();
+        if ((previous_mask & vertex_array_rules) && (rule_mask & vertex_array_rules)) state.bind_vertex_array(vertex_array);
+        if (previous_mask & rule_mask & GL_LAYER_RULE_REDUNDANT_STATE) state.active_texture(GL_TEXTURE0 + active_unit);
+    }
+}
+
+void Context::update_entry_point_flags() {
+    for (std::size_t i = 0; i < entry_point_count; ++i) {
+        auto entry_point = static_cast<EntryPoint>(i);
+        std::uint8_t flags = 0;
+        if (rule_enabled(entry_point_rules(entry_point))) flags |= entry_point_validated;
+        // Entry points of rules that are compiled out have no dispatch code, so there is nothing to record them with.
+        if (trace && entry_point_compiled(entry_point)) flags |= entry_point_traced;
+        entry_point_flags[i] = flags;
+    }
+}
+
+bool Context::start_trace(const char* path, std::uint64_t size) {
+    // The new trace may go to the same file, close that first.
+    trace.reset();
+    trace = TraceWriter::create(path, size, gl_version);
+    update_entry_point_flags();
+    return trace != nullptr;
+}
+
+void Context::stop_trace() {
+    trace.reset();
+    update_entry_point_flags();
+}
+
+void Context::set_sampling(GLLayerSamplingMode mode, std::uint32_t period) {
+    sampling_mode = mode;
+    sampling_period = period > 0 ? period : 1;
+    // The next call to every entry point, or the current frame, is sampled.
+    for (std::uint32_t& countdown : sample_countdowns) countdown = 1;
+    frame_countdown = sampling_period;
+    sampled = true;
+}
+
+void Context::end_frame() {
+    if (trace) trace->record_end_frame();
+    report_frame();
+    if (dedup_enabled && dedup.summary_due(summary_interval)) report_suppressed();
+
+    if (sampling_mode == GL_LAYER_SAMPLE_FRAMES) {
+        sampled = --frame_countdown == 0;
+        if (sampled) frame_countdown = sampling_period;
+    }
+}
+
+void Context::report_frame() {
+    GLLayerFrameStats stats{};
+    stats.frame = frames_ended++;
+    stats.redundant_program_binds = redundant_calls[static_cast<std::size_t>(EntryPoint::glUseProgram)];
+    for (std::size_t i = 0; i < entry_point_count; ++i) {
+        stats.state_changes += state_calls[i];
+        stats.redundant_state_changes += redundant_calls[i];
+    }
+
+    // Counts are only collected while the rule is enabled, but it may have been disabled during the frame. Summaries are
+    // not deduplicated, that would hide how the counts develop from frame to frame.
+    if (rule_enabled(GL_LAYER_RULE_REDUNDANT_STATE) && stats.redundant_state_changes > 0) {
+        for (std::size_t i = 0; i < entry_point_count; ++i) {
+            auto entry_point = static_cast<EntryPoint>(i);
+            // Redundant program binds are reported per program below.
+            if (redundant_calls[i] == 0 || entry_point == EntryPoint::glUseProgram) continue;
+            deliver(make_message(MessageId::RedundantStateChanges, entry_point, {}, redundant_calls[i], state_calls[i]));
+        }
+
+        std::sort(redundant_binds.begin(), redundant_binds.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (std::size_t i = 0; i < redundant_binds.size();) {
+            GLuint program = redundant_binds[i].first;
+            std::uint32_t count = 0;
+            for (; i < redundant_binds.size() && redundant_binds[i].first == program; ++i) {
+                count += redundant_binds[i].second;
+            }
+            deliver(make_message(MessageId::RedundantProgramBinds, EntryPoint::glUseProgram, { program }, count));
+        }
+    }
+
+    std::sort(uniform_uploads.begin(), uniform_uploads.end(), [](const auto& a, const auto& b) { return a.program < b.program; });
+    for (const UniformUploads& uploads : uniform_uploads) {
+        stats.uniform_uploads += uploads.uploads;
+        stats.redundant_uniform_uploads += uploads.redundant;
+        stats.redundant_uniform_bytes += uploads.redundant_bytes;
+        if (rule_enabled(GL_LAYER_RULE_REDUNDANT_UNIFORMS) && uploads.redundant > 0) {
+            deliver(make_message(MessageId::RedundantUniformUploads, EntryPoint::Unknown, { uploads.program }, uploads.redundant,
+                                 uploads.uploads, uploads.redundant_bytes));
+        }
+    }
+
+    last_frame_stats = stats;
+    std::fill(std::begin(state_calls), std::end(state_calls), 0u);
+    std::fill(std::begin(redundant_calls), std::end(redundant_calls), 0u);
+    redundant_binds.clear();
+    uniform_uploads.clear();
+    last_uniform_uploads = 0;
+}
+
+void Context::deliver(const GLLayerMessage& message) {
+    if (async_output) {
+        async_output->push(message);
+    } else {
+        deliver_message(sink, message);
+    }
+}
+
+void Context::report_suppressed() {
+    dedup.drain_suppressed([this](const GLLayerMessage& message) { deliver(message); });
 }
 
+void Context::forget_messages(GLuint handle) {
+    if (dedup_enabled) dedup.forget_handle(handle, [this](const GLLayerMessage& message) { deliver(message); });
+}
 
 namespace {
+// The context created by gl_layer_init(), used by threads that did not make a context current.
 Context* g_context = nullptr;
+
+// Contexts that were not destroyed yet, with a serial number so a new context at the address of a destroyed one is not
+// mistaken for it. Destroying a context bumps the generation, which makes every thread check its current context again.
+std::mutex g_contexts_mutex;
+std::unordered_map<Context*, std::uint64_t> g_contexts;
+std::uint64_t g_next_serial = 0;
+std::atomic<std::uint64_t> g_destroy_generation{ 0 };
+
+thread_local Context* t_current_context = nullptr;
+thread_local std::uint64_t t_current_serial = 0;
+thread_local std::uint64_t t_checked_generation = 0;
+
+Context* register_context(Context* context) {
+    std::lock_guard<std::mutex> lock(g_contexts_mutex);
+    g_contexts.emplace(context, ++g_next_serial);
+    return context;
 }
 
-} // namespace gl_layer
+void destroy_context(Context* context) {
+    {
+        std::lock_guard<std::mutex> lock(g_contexts_mutex);
+        g_contexts.erase(context);
+        g_destroy_generation.fetch_add(1, std::memory_order_release);
+    }
+    delete context;
+}
+
+void set_current_context(Context* context) {
+    std::lock_guard<std::mutex> lock(g_contexts_mutex);
+    auto it = g_contexts.find(context);
+    t_current_context = it != g_contexts.end() ? context : nullptr;
+    t_current_serial = it != g_contexts.end() ? it->second : 0;
+    t_checked_generation = g_destroy_generation.load(std::memory_order_relaxed);
+}
+
+// Only runs after a context was destroyed somewhere. Drops the current context of this thread if it was that one.
+Context* check_current_context() {
+    std::lock_guard<std::mutex> lock(g_contexts_mutex);
+    auto it = g_contexts.find(t_current_context);
+    if (it == g_contexts.end() || it->second != t_current_serial) t_current_context = nullptr;
+    t_checked_generation = g_destroy_generation.load(std::memory_order_relaxed);
+    return t_current_context;
+}
+
+Context* current_context() {
+    Context* context = t_current_context;
+    if (context && t_checked_generation != g_destroy_generation.load(std::memory_order_acquire)) {
+        context = check_current_context();
+    }
+    return context ? context : g_context;
+}
 
-static bool is_func(std::string_view name, std::string_view func) {
-    return func == name;
+// Passes a call to EP to the current context, if it needs to see the call. Entry points of rules that are compiled out
+// are never validated, and their Context methods are never referenced.
+template<EntryPoint EP, auto Method, typename... Args>
+void dispatch(Args... args) {
+    if constexpr (entry_point_compiled(EP)) {
+        Context* context = current_context();
+        if (context && context->entry_point_enabled(EP)) context->call<EP, Method>(args...);
+    }
+}
+
+struct RuleName {
+    std::string_view name;
+    std::uint32_t mask;
+};
+
+constexpr RuleName rule_names[] = {
+    { "none", GL_LAYER_RULE_NONE },
+    { "all", GL_LAYER_RULE_ALL },
+    { "shader_compile", GL_LAYER_RULE_SHADER_COMPILE },
+    { "program_link", GL_LAYER_RULE_PROGRAM_LINK },
+    { "program_bound", GL_LAYER_RULE_PROGRAM_BOUND },
+    { "redundant_state", GL_LAYER_RULE_REDUNDANT_STATE },
+    { "draw_state", GL_LAYER_RULE_DRAW_STATE },
+    { "uniform", GL_LAYER_RULE_UNIFORM },
+    { "redundant_uniforms", GL_LAYER_RULE_REDUNDANT_UNIFORMS },
+};
+
+}
+
+std::uint32_t parse_rule_mask(std::string_view text) {
+    if (!text.empty() && text[0] >= '0' && text[0] <= '9') {
+        return static_cast<std::uint32_t>(std::strtoul(std::string(text).c_str(), nullptr, 0));
+    }
+
+    std::uint32_t mask = GL_LAYER_RULE_NONE;
+    while (!text.empty()) {
+        std::size_t end = std::min(text.find(','), text.size());
+        std::string_view name = text.substr(0, end);
+        while (!name.empty() && name.front() == ' ') name.remove_prefix(1);
+        while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+        for (const RuleName& rule : rule_names) {
+            if (rule.name == name) mask |= rule.mask;
+        }
+        text.remove_prefix(std::min(end + 1, text.size()));
+    }
+    return mask;
+}
+
+namespace {
+constexpr std::uint64_t default_trace_size = 16 * 1024 * 1024;
+
+const char* read_environment(const char* name) {
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4996) // getenv is fine here, the value is only read once during initialization.
+#endif
+    return std::getenv(name);
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+// Arguments passed through ... undergo default argument promotion, so they must be read back as the promoted type.
+template<typename T>
+using promoted_t = std::conditional_t<std::is_floating_point_v<T>, double,
+                   std::conditional_t<std::is_integral_v<T> && sizeof(T) < sizeof(int), int, T>>;
+
+template<EntryPoint EP, auto Method, typename... Args>
+void call_with_varargs(Context& ctx, void (Context::*)(Args...), std::va_list& args) {
+    // Note that the parameters must be pulled before the call, since there is no guarantee that function arguments
+    // evaluate in order. Braced initialization does guarantee left to right evaluation.
+    std::tuple<Args...> values{ static_cast<Args>(va_arg(args, promoted_t<Args>))... };
+    std::apply([&ctx](Args... unpacked) { ctx.call<EP, Method>(unpacked...); }, values);
+}
+
+template<EntryPoint EP, auto Method>
+void dispatch_varargs(Context& ctx, std::va_list& args) {
+    call_with_varargs<EP, Method>(ctx, Method, args);
+}
+
+using VarargsHandler = void (*)(Context&, std::va_list&);
+
+template<EntryPoint EP, auto Method>
+constexpr VarargsHandler varargs_handler() {
+    if constexpr (entry_point_compiled(EP)) {
+        return &dispatch_varargs<EP, Method>;
+    } else {
+        return nullptr;
+    }
 }
 
+// Entries are null for entry points that are compiled out, those are never enabled.
+constexpr VarargsHandler varargs_handlers[entry_point_count] = {
+#define GL_LAYER_VARARGS_HANDLER(name, rules, params) varargs_handler<EntryPoint::name, &Context::name>(),
+    GL_LAYER_ENTRY_POINTS(GL_LAYER_VARARGS_HANDLER)
+#undef GL_LAYER_VARARGS_HANDLER
+};
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#define GL_LAYER_APIENTRY __stdcall
+#else
+#define GL_LAYER_APIENTRY
+#endif
+
+// Driver functions for the validated entry points, filled in by the interposing loader. There is one set for the whole
+// process, loading again replaces the functions behind every wrapper. Wrappers may already run on other threads while
+// that happens, and only need the pointer itself, so relaxed accesses are enough.
+std::atomic<void*> real_procs[entry_point_count] = {};
+
+// Stands in for a validated OpenGL function: calls the driver, then validates the call like gl_layer_callback would.
+template<EntryPoint EP, auto Method, typename = decltype(Method)>
+struct InterposeWrapper;
+
+template<EntryPoint EP, auto Method, typename... Args>
+struct InterposeWrapper<EP, Method, void (Context::*)(Args...)> {
+    using Proc = void (GL_LAYER_APIENTRY*)(Args...);
+
+    static void GL_LAYER_APIENTRY call(Args... args) {
+        reinterpret_cast<Proc>(real_procs[static_cast<std::size_t>(EP)].load(std::memory_order_relaxed))(args...);
+        dispatch<EP, Method>(args...);
+    }
+};
+
+template<EntryPoint EP, auto Method>
+void* wrapper_proc() {
+    if constexpr (entry_point_compiled(EP)) {
+        return reinterpret_cast<void*>(&InterposeWrapper<EP, Method>::call);
+    } else {
+        return nullptr;
+    }
+}
+
+// Entries are null for entry points that are compiled out, the loader hands out the driver function for those.
+void* const wrapper_procs[entry_point_count] = {
+#define GL_LAYER_WRAPPER_PROC(name, rules, params) wrapper_proc<EntryPoint::name, &Context::name>(),
+    GL_LAYER_ENTRY_POINTS(GL_LAYER_WRAPPER_PROC)
+#undef GL_LAYER_WRAPPER_PROC
+};
+
+std::atomic<GLLayerLoadProc> user_load_proc{ nullptr };
+
+void* interposing_get_proc_address(const char* name) {
+    void* proc = user_load_proc.load(std::memory_order_relaxed)(name);
+    EntryPoint entry_point = find_entry_point(name);
+    if (proc == nullptr || entry_point == EntryPoint::Unknown || !wrapper_procs[static_cast<std::size_t>(entry_point)]) {
+        return proc;
+    }
+
+    real_procs[static_cast<std::size_t>(entry_point)].store(proc, std::memory_order_relaxed);
+    return wrapper_procs[static_cast<std::size_t>(entry_point)];
+}
+
+// The layer must call the driver directly, if it was handed one of its own wrappers it would validate its own queries.
+template<typename F>
+F unwrap_proc(F proc) {
+    for (std::size_t i = 0; i < entry_point_count; ++i) {
+        if (wrapper_procs[i] && reinterpret_cast<void*>(proc) == wrapper_procs[i]) {
+            return reinterpret_cast<F>(real_procs[i].load(std::memory_order_relaxed));
+        }
+    }
+    return proc;
+}
+
+Context* create_context(Version version, const ContextGLFunctions* gl_functions, std::shared_ptr<ShareGroup> share_group) {
+    ContextGLFunctions functions = *gl_functions;
+    functions.GetActiveUniform = unwrap_proc(functions.GetActiveUniform);
+    functions.GetUniformLocation = unwrap_proc(functions.GetUniformLocation);
+    functions.GetProgramiv = unwrap_proc(functions.GetProgramiv);
+
+    auto* context = register_context(new Context(version, &functions, std::move(share_group)));
+    if (const char* rules = read_environment("GL_LAYER_RULES")) {
+        context->set_rule_mask(parse_rule_mask(rules));
+    }
+    return context;
+}
+
+// GLLayerContext is never defined, handles are Context pointers.
+Context* to_context(GLLayerContext* handle) {
+    return reinterpret_cast<Context*>(handle);
+}
+
+GLLayerContext* to_handle(Context* context) {
+    return reinterpret_cast<GLLayerContext*>(context);
+}
+}
+
+} // namespace gl_layer
+
 [[maybe_unused]] static bool func_has(std::string_view name, std::string_view substr) {
     return name.find(substr) != std::string_view::npos;
 }
 
 int gl_layer_init(unsigned int gl_version_major, unsigned int gl_version_minor, const ContextGLFunctions* gl_functions) {
-    gl_layer::g_context = new gl_layer::Context(gl_layer::Version{ gl_version_major, gl_version_minor }, gl_functions);
-    if (gl_layer::g_context) return 0;
+    gl_layer::g_context = gl_layer::create_context(gl_layer::Version{ gl_version_major, gl_version_minor }, gl_functions, nullptr);
+    if (!gl_layer::g_context) return -1;
 
-    return -1;
+    // Only for this context, other contexts would overwrite the same file.
+    if (const char* trace_path = gl_layer::read_environment("GL_LAYER_TRACE")) {
+        gl_layer::g_context->start_trace(trace_path, gl_layer::default_trace_size);
+    }
+    return 0;
 }
 
 void gl_layer_terminate() {
-    delete gl_layer::g_context;
+    if (!gl_layer::g_context) return;
+
+    gl_layer::destroy_context(gl_layer::g_context);
+    gl_layer::g_context = nullptr;
+}
+
+GLLayerContext* gl_layer_create_context(unsigned int gl_version_major, unsigned int gl_version_minor,
+                                        const ContextGLFunctions* gl_functions, GLLayerContext* share_context) {
+    std::shared_ptr<gl_layer::ShareGroup> share_group;
+    if (share_context) {
+        share_group = gl_layer::to_context(share_context)->get_share_group();
+    }
+
+    gl_layer::Context* context =
+      gl_layer::create_context(gl_layer::Version{ gl_version_major, gl_version_minor }, gl_functions, std::move(share_group));
+    if (gl_layer::g_context) {
+        context->inherit_settings(*gl_layer::g_context);
+    }
+    return gl_layer::to_handle(context);
+}
+
+void gl_layer_destroy_context(GLLayerContext* context) {
+    if (!context) return;
+
+    gl_layer::Context* layer_context = gl_layer::to_context(context);
+    if (gl_layer::g_context == layer_context) {
+        gl_layer::g_context = nullptr;
+    }
+    gl_layer::destroy_context(layer_context);
+}
+
+void gl_layer_make_current(GLLayerContext* context) {
+    gl_layer::set_current_context(gl_layer::to_context(context));
+}
+
+GLLayerContext* gl_layer_get_current_context() {
+    return gl_layer::to_handle(gl_layer::current_context());
+}
+
+GLLayerLoadProc gl_layer_load(GLLayerLoadProc load_proc) {
+    if constexpr (gl_layer::compiled_rules == GL_LAYER_RULE_NONE) {
+        // Nothing to validate, the application talks to the driver directly.
+        return load_proc;
+    }
+
+    gl_layer::user_load_proc.store(load_proc, std::memory_order_relaxed);
+    return &gl_layer::interposing_get_proc_address;
 }
 
 void gl_layer_callback(const char* name_c, void* func_ptr, int num_args, ...) {
-    if (!gl_layer::g_context) {
-        // Report error: context not initialized.
+    if constexpr (gl_layer::compiled_rules == GL_LAYER_RULE_NONE) {
         return;
     }
 
-    using namespace gl_layer; // GL types
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
+        // Report error: context not initialized.
+        return;
+    }
 
-    std::string_view name = name_c;
+    // Functions the layer does not validate and functions no enabled rule needs are both rejected here, before any
+    // arguments are read.
+    gl_layer::EntryPoint entry_point = context->resolve_entry_point(name_c, func_ptr);
+    if (!context->entry_point_enabled(entry_point)) {
+        return;
+    }
 
     va_list args;
     va_start(args, num_args);
+    gl_layer::varargs_handlers[static_cast<std::size_t>(entry_point)](*context, args);
+    va_end(args);
+}
 
-    if (is_func(name, "glCompileShader")) {
-        auto shader = va_arg(args, GLuint);
-        gl_layer::g_context->glCompileShader(shader);
-    } else if (is_func(name, "glGetShaderiv")) {
-        auto shader = va_arg(args, GLuint);
-        gl_layer::GLenum param = va_arg(args, GLenum);
-        auto* params = va_arg(args, GLint*);
-        gl_layer::g_context->glGetShaderiv(shader, param, params);
-    } else if (is_func(name, "glAttachShader")) {
-        // Note that the parameters must be pulled outside the function call, since there is no guarantee that they will evaluate in order!
-        auto program = va_arg(args, GLuint);
-        auto shader = va_arg(args, GLuint);
-        gl_layer::g_context->glAttachShader(program, shader);
-    } else if (is_func(name, "glGetProgramiv")) {
-        auto program = va_arg(args, GLuint);
-        gl_layer::GLenum param = va_arg(args, GLenum);
-        auto* params = va_arg(args, GLint*);
-        gl_layer::g_context->glGetProgramiv(program, param, params);
-    } else if (is_func(name, "glUseProgram")) {
-        auto program = va_arg(args, GLuint);
-        gl_layer::g_context->glUseProgram(program);
-    } else if (is_func(name, "glLinkProgram")) {
-        auto program = va_arg(args, GLuint);
-        gl_layer::g_context->glLinkProgram(program);
-    }
+void gl_layer_on_glCompileShader(unsigned int shader) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glCompileShader, &gl_layer::Context::glCompileShader>(shader);
+}
 
-    va_end(args);
+void gl_layer_on_glGetShaderiv(unsigned int shader, unsigned int pname, int* params) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glGetShaderiv, &gl_layer::Context::glGetShaderiv>(shader, pname, params);
+}
+
+void gl_layer_on_glAttachShader(unsigned int program, unsigned int shader) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glAttachShader, &gl_layer::Context::glAttachShader>(program, shader);
+}
+
+void gl_layer_on_glGetProgramiv(unsigned int program, unsigned int pname, int* params) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glGetProgramiv, &gl_layer::Context::glGetProgramiv>(program, pname, params);
+}
+
+void gl_layer_on_glLinkProgram(unsigned int program) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glLinkProgram, &gl_layer::Context::glLinkProgram>(program);
+}
+
+void gl_layer_on_glUseProgram(unsigned int program) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUseProgram, &gl_layer::Context::glUseProgram>(program);
+}
+
+void gl_layer_on_glDeleteProgram(unsigned int program) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDeleteProgram, &gl_layer::Context::glDeleteProgram>(program);
+}
+
+void gl_layer_on_glDeleteShader(unsigned int shader) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDeleteShader, &gl_layer::Context::glDeleteShader>(shader);
+}
+
+void gl_layer_on_glEnable(unsigned int cap) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glEnable, &gl_layer::Context::glEnable>(cap);
+}
+
+void gl_layer_on_glDisable(unsigned int cap) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDisable, &gl_layer::Context::glDisable>(cap);
+}
+
+void gl_layer_on_glActiveTexture(unsigned int texture) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glActiveTexture, &gl_layer::Context::glActiveTexture>(texture);
+}
+
+void gl_layer_on_glBindTexture(unsigned int target, unsigned int texture) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glBindTexture, &gl_layer::Context::glBindTexture>(target, texture);
+}
+
+void gl_layer_on_glDeleteTextures(int n, const unsigned int* textures) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDeleteTextures, &gl_layer::Context::glDeleteTextures>(n, textures);
+}
+
+void gl_layer_on_glBindBuffer(unsigned int target, unsigned int buffer) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glBindBuffer, &gl_layer::Context::glBindBuffer>(target, buffer);
+}
+
+void gl_layer_on_glBindBufferBase(unsigned int target, unsigned int index, unsigned int buffer) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glBindBufferBase, &gl_layer::Context::glBindBufferBase>(target, index, buffer);
+}
+
+void gl_layer_on_glBindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, ptrdiff_t offset, ptrdiff_t size) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glBindBufferRange, &gl_layer::Context::glBindBufferRange>(target, index, buffer, offset, size);
+}
+
+void gl_layer_on_glDeleteBuffers(int n, const unsigned int* buffers) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDeleteBuffers, &gl_layer::Context::glDeleteBuffers>(n, buffers);
+}
+
+void gl_layer_on_glBindVertexArray(unsigned int array) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glBindVertexArray, &gl_layer::Context::glBindVertexArray>(array);
+}
+
+void gl_layer_on_glDeleteVertexArrays(int n, const unsigned int* arrays) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDeleteVertexArrays, &gl_layer::Context::glDeleteVertexArrays>(n, arrays);
+}
+
+void gl_layer_on_glBlendFunc(unsigned int sfactor, unsigned int dfactor) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glBlendFunc, &gl_layer::Context::glBlendFunc>(sfactor, dfactor);
+}
+
+void gl_layer_on_glDepthFunc(unsigned int func) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDepthFunc, &gl_layer::Context::glDepthFunc>(func);
+}
+
+void gl_layer_on_glUniform1f(int location, float v0) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform1f, &gl_layer::Context::glUniform1f>(location, v0);
+}
+
+void gl_layer_on_glUniform2f(int location, float v0, float v1) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform2f, &gl_layer::Context::glUniform2f>(location, v0, v1);
+}
+
+void gl_layer_on_glUniform3f(int location, float v0, float v1, float v2) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform3f, &gl_layer::Context::glUniform3f>(location, v0, v1, v2);
+}
+
+void gl_layer_on_glUniform4f(int location, float v0, float v1, float v2, float v3) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform4f, &gl_layer::Context::glUniform4f>(location, v0, v1, v2, v3);
+}
+
+void gl_layer_on_glUniform1i(int location, int v0) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform1i, &gl_layer::Context::glUniform1i>(location, v0);
+}
+
+void gl_layer_on_glUniform2i(int location, int v0, int v1) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform2i, &gl_layer::Context::glUniform2i>(location, v0, v1);
+}
+
+void gl_layer_on_glUniform3i(int location, int v0, int v1, int v2) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform3i, &gl_layer::Context::glUniform3i>(location, v0, v1, v2);
+}
+
+void gl_layer_on_glUniform4i(int location, int v0, int v1, int v2, int v3) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform4i, &gl_layer::Context::glUniform4i>(location, v0, v1, v2, v3);
+}
+
+void gl_layer_on_glUniform1ui(int location, unsigned int v0) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform1ui, &gl_layer::Context::glUniform1ui>(location, v0);
+}
+
+void gl_layer_on_glUniform2ui(int location, unsigned int v0, unsigned int v1) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform2ui, &gl_layer::Context::glUniform2ui>(location, v0, v1);
+}
+
+void gl_layer_on_glUniform3ui(int location, unsigned int v0, unsigned int v1, unsigned int v2) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform3ui, &gl_layer::Context::glUniform3ui>(location, v0, v1, v2);
+}
+
+void gl_layer_on_glUniform4ui(int location, unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform4ui, &gl_layer::Context::glUniform4ui>(location, v0, v1, v2, v3);
+}
+
+void gl_layer_on_glUniform1fv(int location, int count, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform1fv, &gl_layer::Context::glUniform1fv>(location, count, value);
+}
+
+void gl_layer_on_glUniform2fv(int location, int count, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform2fv, &gl_layer::Context::glUniform2fv>(location, count, value);
+}
+
+void gl_layer_on_glUniform3fv(int location, int count, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform3fv, &gl_layer::Context::glUniform3fv>(location, count, value);
+}
+
+void gl_layer_on_glUniform4fv(int location, int count, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform4fv, &gl_layer::Context::glUniform4fv>(location, count, value);
+}
+
+void gl_layer_on_glUniform1iv(int location, int count, const int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform1iv, &gl_layer::Context::glUniform1iv>(location, count, value);
+}
+
+void gl_layer_on_glUniform2iv(int location, int count, const int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform2iv, &gl_layer::Context::glUniform2iv>(location, count, value);
+}
+
+void gl_layer_on_glUniform3iv(int location, int count, const int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform3iv, &gl_layer::Context::glUniform3iv>(location, count, value);
+}
+
+void gl_layer_on_glUniform4iv(int location, int count, const int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform4iv, &gl_layer::Context::glUniform4iv>(location, count, value);
+}
+
+void gl_layer_on_glUniform1uiv(int location, int count, const unsigned int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform1uiv, &gl_layer::Context::glUniform1uiv>(location, count, value);
+}
+
+void gl_layer_on_glUniform2uiv(int location, int count, const unsigned int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform2uiv, &gl_layer::Context::glUniform2uiv>(location, count, value);
+}
+
+void gl_layer_on_glUniform3uiv(int location, int count, const unsigned int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform3uiv, &gl_layer::Context::glUniform3uiv>(location, count, value);
+}
+
+void gl_layer_on_glUniform4uiv(int location, int count, const unsigned int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniform4uiv, &gl_layer::Context::glUniform4uiv>(location, count, value);
+}
+
+void gl_layer_on_glUniformMatrix2fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix2fv, &gl_layer::Context::glUniformMatrix2fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glUniformMatrix3fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix3fv, &gl_layer::Context::glUniformMatrix3fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glUniformMatrix4fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix4fv, &gl_layer::Context::glUniformMatrix4fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glUniformMatrix2x3fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix2x3fv, &gl_layer::Context::glUniformMatrix2x3fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glUniformMatrix3x2fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix3x2fv, &gl_layer::Context::glUniformMatrix3x2fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glUniformMatrix2x4fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix2x4fv, &gl_layer::Context::glUniformMatrix2x4fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glUniformMatrix4x2fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix4x2fv, &gl_layer::Context::glUniformMatrix4x2fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glUniformMatrix3x4fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix3x4fv, &gl_layer::Context::glUniformMatrix3x4fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glUniformMatrix4x3fv(int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glUniformMatrix4x3fv, &gl_layer::Context::glUniformMatrix4x3fv>(location, count, transpose, value);
+}
+
+void gl_layer_on_glDrawArrays(unsigned int mode, int first, int count) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDrawArrays, &gl_layer::Context::glDrawArrays>(mode, first, count);
+}
+
+void gl_layer_on_glDrawElements(unsigned int mode, int count, unsigned int type, const void* indices) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDrawElements, &gl_layer::Context::glDrawElements>(mode, count, type, indices);
+}
+
+void gl_layer_on_glDrawArraysInstanced(unsigned int mode, int first, int count, int instancecount) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDrawArraysInstanced, &gl_layer::Context::glDrawArraysInstanced>(mode, first, count, instancecount);
+}
+
+void gl_layer_on_glDrawElementsInstanced(unsigned int mode, int count, unsigned int type, const void* indices, int instancecount) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glDrawElementsInstanced, &gl_layer::Context::glDrawElementsInstanced>(
+      mode, count, type, indices, instancecount);
+}
+
+void gl_layer_on_glProgramUniform1f(unsigned int program, int location, float v0) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform1f, &gl_layer::Context::glProgramUniform1f>(program, location, v0);
+}
+
+void gl_layer_on_glProgramUniform2f(unsigned int program, int location, float v0, float v1) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform2f, &gl_layer::Context::glProgramUniform2f>(program, location, v0, v1);
+}
+
+void gl_layer_on_glProgramUniform3f(unsigned int program, int location, float v0, float v1, float v2) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform3f, &gl_layer::Context::glProgramUniform3f>(program, location, v0, v1, v2);
+}
+
+void gl_layer_on_glProgramUniform4f(unsigned int program, int location, float v0, float v1, float v2, float v3) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform4f, &gl_layer::Context::glProgramUniform4f>(program, location, v0, v1, v2, v3);
+}
+
+void gl_layer_on_glProgramUniform1i(unsigned int program, int location, int v0) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform1i, &gl_layer::Context::glProgramUniform1i>(program, location, v0);
+}
+
+void gl_layer_on_glProgramUniform2i(unsigned int program, int location, int v0, int v1) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform2i, &gl_layer::Context::glProgramUniform2i>(program, location, v0, v1);
+}
+
+void gl_layer_on_glProgramUniform3i(unsigned int program, int location, int v0, int v1, int v2) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform3i, &gl_layer::Context::glProgramUniform3i>(program, location, v0, v1, v2);
+}
+
+void gl_layer_on_glProgramUniform4i(unsigned int program, int location, int v0, int v1, int v2, int v3) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform4i, &gl_layer::Context::glProgramUniform4i>(program, location, v0, v1, v2, v3);
+}
+
+void gl_layer_on_glProgramUniform1ui(unsigned int program, int location, unsigned int v0) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform1ui, &gl_layer::Context::glProgramUniform1ui>(program, location, v0);
+}
+
+void gl_layer_on_glProgramUniform2ui(unsigned int program, int location, unsigned int v0, unsigned int v1) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform2ui, &gl_layer::Context::glProgramUniform2ui>(program, location, v0, v1);
+}
+
+void gl_layer_on_glProgramUniform3ui(unsigned int program, int location, unsigned int v0, unsigned int v1, unsigned int v2) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform3ui, &gl_layer::Context::glProgramUniform3ui>(program, location, v0, v1, v2);
+}
+
+void gl_layer_on_glProgramUniform4ui(unsigned int program, int location, unsigned int v0, unsigned int v1, unsigned int v2, unsigned int v3) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform4ui, &gl_layer::Context::glProgramUniform4ui>(program, location, v0, v1, v2, v3);
+}
+
+void gl_layer_on_glProgramUniform1fv(unsigned int program, int location, int count, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform1fv, &gl_layer::Context::glProgramUniform1fv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform2fv(unsigned int program, int location, int count, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform2fv, &gl_layer::Context::glProgramUniform2fv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform3fv(unsigned int program, int location, int count, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform3fv, &gl_layer::Context::glProgramUniform3fv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform4fv(unsigned int program, int location, int count, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform4fv, &gl_layer::Context::glProgramUniform4fv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform1iv(unsigned int program, int location, int count, const int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform1iv, &gl_layer::Context::glProgramUniform1iv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform2iv(unsigned int program, int location, int count, const int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform2iv, &gl_layer::Context::glProgramUniform2iv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform3iv(unsigned int program, int location, int count, const int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform3iv, &gl_layer::Context::glProgramUniform3iv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform4iv(unsigned int program, int location, int count, const int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform4iv, &gl_layer::Context::glProgramUniform4iv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform1uiv(unsigned int program, int location, int count, const unsigned int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform1uiv, &gl_layer::Context::glProgramUniform1uiv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform2uiv(unsigned int program, int location, int count, const unsigned int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform2uiv, &gl_layer::Context::glProgramUniform2uiv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform3uiv(unsigned int program, int location, int count, const unsigned int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform3uiv, &gl_layer::Context::glProgramUniform3uiv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniform4uiv(unsigned int program, int location, int count, const unsigned int* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniform4uiv, &gl_layer::Context::glProgramUniform4uiv>(program, location, count, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix2fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix2fv, &gl_layer::Context::glProgramUniformMatrix2fv>(
+      program, location, count, transpose, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix3fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix3fv, &gl_layer::Context::glProgramUniformMatrix3fv>(
+      program, location, count, transpose, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix4fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix4fv, &gl_layer::Context::glProgramUniformMatrix4fv>(
+      program, location, count, transpose, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix2x3fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix2x3fv, &gl_layer::Context::glProgramUniformMatrix2x3fv>(
+      program, location, count, transpose, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix3x2fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix3x2fv, &gl_layer::Context::glProgramUniformMatrix3x2fv>(
+      program, location, count, transpose, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix2x4fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix2x4fv, &gl_layer::Context::glProgramUniformMatrix2x4fv>(
+      program, location, count, transpose, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix4x2fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix4x2fv, &gl_layer::Context::glProgramUniformMatrix4x2fv>(
+      program, location, count, transpose, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix3x4fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix3x4fv, &gl_layer::Context::glProgramUniformMatrix3x4fv>(
+      program, location, count, transpose, value);
+}
+
+void gl_layer_on_glProgramUniformMatrix4x3fv(unsigned int program, int location, int count, unsigned char transpose, const float* value) {
+    gl_layer::dispatch<gl_layer::EntryPoint::glProgramUniformMatrix4x3fv, &gl_layer::Context::glProgramUniformMatrix4x3fv>(
+      program, location, count, transpose, value);
+}
+
+int gl_layer_get_compile_stats(GLLayerCompileStats* stats) {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context || !stats) {
+        return -1;
+    }
+    *stats = context->get_compile_stats();
+    return 0;
 }
 
 [[maybe_unused]] void gl_layer_set_output_callback(GLLayerOutputFun callback, void* user_data) {
-    if (!gl_layer::g_context) {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
         // Report error: context not initialized.
         return;
     }
-    gl_layer::g_context->set_output_callback(callback, user_data);
-}
\ No newline at end of file
+    context->set_output_callback(callback, user_data);
+}
+
+void gl_layer_set_message_callback(GLLayerMessageFun callback, void* user_data) {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
+        // Report error: context not initialized.
+        return;
+    }
+    context->set_message_callback(callback, user_data);
+}
+
+int gl_layer_set_async_output(int enabled, unsigned int capacity, GLLayerDropPolicy policy) {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
+        return -1;
+    }
+    context->set_async_output(enabled != 0, capacity, policy);
+    return 0;
+}
+
+void gl_layer_flush_output() {
+    if (gl_layer::Context* context = gl_layer::current_context()) context->flush_output();
+}
+
+int gl_layer_set_message_dedup(int enabled, unsigned int summary_interval_ms) {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
+        return -1;
+    }
+    context->set_message_dedup(enabled != 0, std::chrono::milliseconds(summary_interval_ms));
+    return 0;
+}
+
+int gl_layer_set_rule_mask(unsigned int mask) {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
+        return -1;
+    }
+    context->set_rule_mask(mask);
+    return 0;
+}
+
+unsigned int gl_layer_get_rule_mask() {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
+        return 0;
+    }
+    return context->get_rule_mask();
+}
+
+unsigned long long gl_layer_get_dropped_message_count() {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
+        return 0;
+    }
+    return context->dropped_message_count();
+}
+
+int gl_layer_set_sampling(GLLayerSamplingMode mode, unsigned int period) {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context) {
+        return -1;
+    }
+    context->set_sampling(mode, period);
+    return 0;
+}
+
+void gl_layer_end_frame() {
+    if (gl_layer::Context* context = gl_layer::current_context()) context->end_frame();
+}
+
+int gl_layer_get_frame_stats(GLLayerFrameStats* stats) {
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context || !stats) {
+        return -1;
+    }
+    *stats = context->get_frame_stats();
+    return 0;
+}
+
+int gl_layer_start_trace(const char* path, unsigned long long size) {
+    if constexpr (gl_layer::compiled_rules == GL_LAYER_RULE_NONE) {
+        // No calls are looked at, there would be nothing to record.
+        return -1;
+    }
+
+    gl_layer::Context* context = gl_layer::current_context();
+    if (!context || !path) {
+        return -1;
+    }
+    return context->start_trace(path, size) ? 0 : -1;
+}
+
+void gl_layer_stop_trace() {
+    if (gl_layer::Context* context = gl_layer::current_context()) context->stop_trace();
+}
@@ -0,0 +1,75 @@
+#include <gl_layer/context.h>
+#include <gl_layer/private/context.h>
+
+namespace gl_layer {
+
+void Context::validate_draw(EntryPoint entry_point) {
+    if (!sampled) {
+        return;
+    }
+
+    // Thousands of draws per frame use the same state, those only cost this comparison.
+    std::uint64_t changes = programs.changes_count();
+    if (draw_state_epoch == validated_draw_epoch && changes == validated_draw_changes) {
+        return;
+    }
+
+    bool valid = true;
+    if constexpr (rule_compiled(GL_LAYER_RULE_PROGRAM_BOUND)) {
+        if (rule_enabled(GL_LAYER_RULE_PROGRAM_BOUND)) {
+            valid &= validate_program_bound(entry_point);
+        }
+    }
+
+    if constexpr (rule_compiled(GL_LAYER_RULE_DRAW_STATE)) {
+        // Vertex array objects exist since OpenGL 3.0, before that there is nothing to bind.
+        if (rule_enabled(GL_LAYER_RULE_DRAW_STATE) && gl_version.major >= 3 && state.bound_vertex_array() == 0) {
+            report(MessageId::NoVertexArrayBound, entry_point, {});
+            valid = false;
+        }
+    }
+
+    // Programs are only tracked while their link rule is enabled.
+    if constexpr (rule_compiled(GL_LAYER_RULE_PROGRAM_LINK)) {
+        if (current_program_handle != 0 && rule_enabled(GL_LAYER_RULE_PROGRAM_LINK)) {
+            auto guard = share_group->read();
+            const Program* program_info = validate_program_status(current_program_handle, entry_point);
+            valid &= program_info != nullptr;
+
+            if constexpr (rule_compiled(GL_LAYER_RULE_DRAW_STATE)) {
+                if (program_info && rule_enabled(GL_LAYER_RULE_DRAW_STATE)) {
+                    program_info = find_reflected_program(current_program_handle);
+                    GLint unset = program_info ? program_info->uniform_writes.first_unset(uniform_bitsets) : -1;
+                    if (unset >= 0) {
+                        report(MessageId::UniformNotSet, entry_point, { current_program_handle }, unset);
+                        valid = false;
+                    }
+                }
+            }
+        }
+    }
+
+    // Failures are checked again on every draw, so repeats are still counted.
+    if (valid) {
+        validated_draw_epoch = draw_state_epoch;
+        validated_draw_changes = changes;
+    }
+}
+
+void Context::glDrawArrays(GLenum, GLint, GLsizei) {
+    validate_draw(EntryPoint::glDrawArrays);
+}
+
+void Context::glDrawElements(GLenum, GLsizei, GLenum, const void*) {
+    validate_draw(EntryPoint::glDrawElements);
+}
+
+void Context::glDrawArraysInstanced(GLenum, GLint, GLsizei, GLsizei) {
+    validate_draw(EntryPoint::glDrawArraysInstanced);
+}
+
+void Context::glDrawElementsInstanced(GLenum, GLsizei, GLenum, const void*, GLsizei) {
+    validate_draw(EntryPoint::glDrawElementsInstanced);
+}
+
+}
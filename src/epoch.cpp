@@ -0,0 +1,124 @@
+#include <gl_layer/private/epoch.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gl_layer {
+
+namespace {
+
+constexpr std::size_t max_readers = 256;
+// Retired objects are collected in batches, a reclaim has to look at every reader slot.
+constexpr std::size_t reclaim_threshold = 64;
+
+struct alignas(64) ReaderSlot {
+    // 0 while the owning thread is not reading.
+    std::atomic<std::uint64_t> epoch{ 0 };
+    std::atomic<bool> claimed{ false };
+};
+
+struct Retired {
+    void* object;
+    void (*deleter)(void*);
+    std::uint64_t epoch;
+};
+
+struct Domain {
+    ReaderSlot readers[max_readers];
+    std::atomic<std::uint64_t> global_epoch{ 1 };
+
+    std::mutex retired_mutex;
+    std::vector<Retired> retired;
+
+    ~Domain() {
+        // Every reader thread is gone at static destruction.
+        for (const Retired& item : retired) item.deleter(item.object);
+    }
+
+    ReaderSlot& claim_slot() {
+        for (;;) {
+            for (ReaderSlot& slot : readers) {
+                bool expected = false;
+                if (!slot.claimed.load(std::memory_order_relaxed) &&
+                    slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return slot;
+                }
+            }
+            // More threads are reading than there are slots, wait for one to exit.
+            std::this_thread::yield();
+        }
+    }
+
+    // Requires retired_mutex.
+    void reclaim_locked() {
+        std::uint64_t oldest = UINT64_MAX;
+        for (const ReaderSlot& slot : readers) {
+            std::uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0 && epoch < oldest) oldest = epoch;
+        }
+
+        // A reader that entered in epoch e may have seen anything retired in epoch e or later.
+        std::size_t kept = 0;
+        for (const Retired& item : retired) {
+            if (item.epoch < oldest) {
+                item.deleter(item.object);
+            } else {
+                retired[kept++] = item;
+            }
+        }
+        retired.resize(kept);
+    }
+};
+
+Domain domain;
+
+// Slot of the calling thread, claimed on its first read and given back when the thread exits.
+struct ThreadReader {
+    ReaderSlot* slot = nullptr;
+    unsigned int depth = 0;
+
+    ~ThreadReader() {
+        if (slot) slot->claimed.store(false, std::memory_order_release);
+    }
+};
+
+thread_local ThreadReader t_reader;
+
+}
+
+EpochGuard::EpochGuard(bool active) : active(active) {
+    if (!active || t_reader.depth++ > 0) return;
+
+    if (!t_reader.slot) t_reader.slot = &domain.claim_slot();
+    // Publishing the epoch must be ordered before any pointer is read, and against the writer's scan in
+    // reclaim_locked(), so this store is sequentially consistent.
+    t_reader.slot->epoch.store(domain.global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+EpochGuard::~EpochGuard() {
+    if (!active || --t_reader.depth > 0) return;
+
+    t_reader.slot->epoch.store(0, std::memory_order_release);
+}
+
+void retire(void* object, void (*deleter)(void*)) {
+    // Readers that enter from now on start in a later epoch, and can no longer reach the object.
+    std::uint64_t epoch = domain.global_epoch.fetch_add(1, std::memory_order_seq_cst);
+
+    std::lock_guard<std::mutex> lock(domain.retired_mutex);
+    domain.retired.push_back(Retired{ object, deleter, epoch });
+    if (domain.retired.size() >= reclaim_threshold) {
+        domain.reclaim_locked();
+    }
+}
+
+void reclaim_retired() {
+    std::lock_guard<std::mutex> lock(domain.retired_mutex);
+    domain.reclaim_locked();
+}
+
+}
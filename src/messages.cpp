@@ -0,0 +1,198 @@
+#include <gl_layer/context.h>
+#include <gl_layer/private/messages.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <vector>
+
+namespace gl_layer {
+
+namespace {
+
+// Appends to a fixed buffer like snprintf, but keeps counting the full length once the buffer is full. Plain strings and
+// integers are copied directly, only the other conversions go through vsnprintf.
+struct TextWriter {
+    char* buffer;
+    std::size_t size;
+    std::size_t length = 0;
+
+    void append(std::string_view text) {
+        if (length + 1 < size) {
+            std::size_t count = std::min(text.size(), size - 1 - length);
+            std::memcpy(buffer + length, text.data(), count);
+            buffer[length + count] = '\0';
+        }
+        length += text.size();
+    }
+
+    void append_uint(std::uint64_t value) {
+        char digits[20];
+        std::size_t count = 0;
+        do {
+            digits[sizeof(digits) - 1 - count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        append(std::string_view(digits + sizeof(digits) - count, count));
+    }
+
+    void append_int(std::int64_t value) {
+        if (value < 0) {
+            append("-");
+            append_uint(~static_cast<std::uint64_t>(value) + 1);
+        } else {
+            append_uint(static_cast<std::uint64_t>(value));
+        }
+    }
+
+    void append_fmt(const char* fmt, ...) {
+        char* dst = length < size ? buffer + length : nullptr;
+        std::size_t remaining = length < size ? size - length : 0;
+
+        va_list args;
+        va_start(args, fmt);
+        int written = std::vsnprintf(dst, remaining, fmt, args);
+        va_end(args);
+        if (written > 0) length += static_cast<std::size_t>(written);
+    }
+};
+
+void append_arg(TextWriter& writer, const ParamInfo& param, std::uint64_t raw) {
+    writer.append(param.name);
+    writer.append(" = ");
+    switch (param.kind) {
+        case ParamKind::Int:
+            writer.append_int(static_cast<std::int64_t>(raw));
+            break;
+        case ParamKind::Uint:
+            writer.append_uint(static_cast<std::uint32_t>(raw));
+            break;
+        case ParamKind::Enum: {
+            const char* name = enum_str(static_cast<GLenum>(raw));
+            if (name[0] != '\0') {
+                writer.append(name);
+            } else {
+                writer.append_fmt("0x%X", static_cast<unsigned int>(raw));
+            }
+            break;
+        }
+        case ParamKind::Float: {
+            double value;
+            std::memcpy(&value, &raw, sizeof(value));
+            writer.append_fmt("%g", value);
+            break;
+        }
+        case ParamKind::Boolean:
+            writer.append(raw ? "GL_TRUE" : "GL_FALSE");
+            break;
+        case ParamKind::Pointer:
+            writer.append_fmt("%p", reinterpret_cast<void*>(static_cast<std::uintptr_t>(raw)));
+            break;
+    }
+}
+
+constexpr std::size_t inline_format_size = 1024;
+
+// Per-thread buffer reused for every message, so delivering text does not allocate once it fits the longest message.
+char* format_buffer(std::size_t size) {
+    thread_local char inline_buffer[inline_format_size];
+    thread_local std::vector<char> overflow_buffer;
+
+    if (size <= inline_format_size) {
+        return inline_buffer;
+    }
+    if (overflow_buffer.size() < size) {
+        overflow_buffer.resize(size);
+    }
+    return overflow_buffer.data();
+}
+
+}
+
+std::size_t format_message(const GLLayerMessage& message, char* buffer, std::size_t size) {
+    TextWriter writer{ buffer, size };
+    auto id = static_cast<MessageId>(message.id);
+
+    if (id == MessageId::RepeatsSuppressed) {
+        auto suppressed = static_cast<MessageId>(message.args[0]);
+        writer.append_fmt(message_text(id), static_cast<unsigned long long>(message.args[1]), message_id_name(suppressed).data(),
+                          message.handles[0]);
+        return writer.length;
+    }
+
+    // Sums up uploads from all glUniform functions, no single one of them.
+    if (id == MessageId::RedundantUniformUploads) {
+        writer.append_fmt(message_text(id), message.handles[0], static_cast<unsigned long long>(message.args[0]),
+                          static_cast<unsigned long long>(message.args[1]), static_cast<unsigned long long>(message.args[2]));
+        return writer.length;
+    }
+
+    auto entry_point = static_cast<EntryPoint>(message.entry_point);
+    writer.append(entry_point_name(entry_point));
+
+    // Messages with conversions in their text fill them from the message, instead of printing the call arguments.
+    // Frame summaries are about many calls, not one.
+    switch (id) {
+        case MessageId::RedundantProgramBinds:
+            writer.append(": ");
+            writer.append_fmt(message_text(id), message.handles[0], static_cast<unsigned long long>(message.args[0]));
+            return writer.length;
+        case MessageId::RedundantStateChanges:
+            writer.append(": ");
+            writer.append_fmt(message_text(id), static_cast<unsigned long long>(message.args[0]),
+                              static_cast<unsigned long long>(message.args[1]));
+            return writer.length;
+        case MessageId::UniformNotSet:
+            writer.append(": ");
+            writer.append_fmt(message_text(id), static_cast<unsigned long long>(message.args[0]), message.handles[0]);
+            return writer.length;
+        default:
+            break;
+    }
+
+    // Messages that do not carry the arguments of the call only print the function name.
+    std::size_t param_count = entry_point_param_count(entry_point);
+    if (message.arg_count > 0 && message.arg_count == param_count) {
+        const ParamInfo* params = entry_point_params(entry_point);
+        writer.append("(");
+        for (std::size_t i = 0; i < param_count; ++i) {
+            if (i > 0) writer.append(", ");
+            append_arg(writer, params[i], message.args[i]);
+        }
+        writer.append(")");
+    }
+
+    writer.append(": ");
+    writer.append(message_text(id));
+    return writer.length;
+}
+
+void deliver_message(const MessageSink& sink, const GLLayerMessage& message) {
+    if (sink.message_fun) {
+        sink.message_fun(&message, sink.message_user_data);
+        return;
+    }
+
+    char* buf = format_buffer(inline_format_size);
+    std::size_t length = format_message(message, buf, inline_format_size);
+    if (length >= inline_format_size) {
+        buf = format_buffer(length + 1); // Extra space for null terminator
+        format_message(message, buf, length + 1);
+    }
+    sink.output_fun(buf, sink.output_user_data);
+}
+
+}
+
+size_t gl_layer_format_message(const GLLayerMessage* message, char* buffer, size_t size) {
+    if (!message) return 0;
+    return gl_layer::format_message(*message, buffer, size);
+}
+
+const char* gl_layer_message_id_name(unsigned int id) {
+    return gl_layer::message_id_name(static_cast<gl_layer::MessageId>(id)).data();
+}
+
+const char* gl_layer_entry_point_name(unsigned int entry_point) {
+    return gl_layer::entry_point_name(static_cast<gl_layer::EntryPoint>(entry_point)).data();
+}
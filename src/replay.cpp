@@ -0,0 +1,156 @@
+#include <gl_layer/private/replay.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace gl_layer {
+
+namespace {
+
+// Driver functions are plain function pointers, they find the replay that is running through this.
+thread_local TraceReplay* t_replay = nullptr;
+
+// Arrays the call reads point to the copy of the recorded array, other pointers keep the address they had in the
+// recording process, the layer never reads through those.
+template<typename T>
+T replay_arg(const TraceRecord& record, std::size_t index, std::size_t arg_count, void* array) {
+    if constexpr (std::is_pointer_v<T>) {
+        if (array && index == arg_count - 1) return static_cast<T>(array);
+    }
+    return from_trace_arg<T>(record.args[index]);
+}
+
+template<EntryPoint EP, auto Method, typename... Args, std::size_t... Indices>
+void replay_with_args(Context& context, void (Context::*)(Args...), std::index_sequence<Indices...>, const TraceRecord& record,
+                      void* array) {
+    context.call<EP, Method>(replay_arg<Args>(record, Indices, sizeof...(Args), array)...);
+}
+
+using ReplayHandler = void (*)(Context&, const TraceRecord&, void*);
+
+template<EntryPoint EP, auto Method>
+constexpr ReplayHandler replay_handler() {
+    if constexpr (entry_point_compiled(EP)) {
+        return [](Context& context, const TraceRecord& record, void* array) {
+            replay_with_args<EP, Method>(context, Method, std::make_index_sequence<entry_point_param_count(EP)>(), record, array);
+        };
+    } else {
+        return nullptr;
+    }
+}
+
+// Entries are null for entry points that are compiled out, calls to those are skipped.
+constexpr ReplayHandler replay_handlers[entry_point_count] = {
+#define GL_LAYER_REPLAY_HANDLER(name, rules, params) replay_handler<EntryPoint::name, &Context::name>(),
+    GL_LAYER_ENTRY_POINTS(GL_LAYER_REPLAY_HANDLER)
+#undef GL_LAYER_REPLAY_HANDLER
+};
+
+}
+
+TraceReplay::TraceReplay(const TraceReader& trace_reader) : reader(trace_reader) {
+    // Reflections are recorded after the call that caused them, the results have to be known before that call is
+    // replayed.
+    std::unordered_map<GLuint, std::uint32_t> link_counts;
+    reader.for_each([this, &link_counts](const TraceRecord& record) {
+        if (record.entry_point == EntryPoint::glLinkProgram) {
+            ++link_counts[static_cast<GLuint>(record.args[0])];
+        } else if (record.tag == static_cast<std::uint8_t>(TraceTag::ProgramUniforms)) {
+            auto program = static_cast<GLuint>(record.args[0]);
+            std::vector<TraceUniform>& uniforms = reflections[reflection_key(program, link_counts[program])];
+            uniforms.resize(record.array_bytes / sizeof(TraceUniform));
+            std::memcpy(uniforms.data(), record.array, uniforms.size() * sizeof(TraceUniform));
+        }
+    });
+    array_buffer.reserve(trace_block_size / sizeof(std::uint32_t));
+}
+
+const ContextGLFunctions& TraceReplay::gl_functions() {
+    static const ContextGLFunctions functions{ &get_active_uniform, &get_uniform_location, &get_programiv };
+    return functions;
+}
+
+bool TraceReplay::run(Context& context) {
+    replay_stats = Stats{};
+    links.clear();
+
+    t_replay = this;
+    bool complete = reader.for_each([this, &context](const TraceRecord& record) {
+        if (record.tag == static_cast<std::uint8_t>(TraceTag::EndFrame)) {
+            context.end_frame();
+            ++replay_stats.frames;
+        } else if (record.entry_point != EntryPoint::Unknown) {
+            replay_call(context, record);
+        }
+    });
+    t_replay = nullptr;
+    return complete;
+}
+
+void TraceReplay::replay_call(Context& context, const TraceRecord& record) {
+    ReplayHandler handler = replay_handlers[static_cast<std::size_t>(record.entry_point)];
+    if (!handler) return;
+
+    if (record.entry_point == EntryPoint::glLinkProgram) {
+        ++links[static_cast<GLuint>(record.args[0])];
+    }
+
+    // The writer leaves out arrays that do not fit a block, but records a null pointer as null.
+    void* array = nullptr;
+    std::size_t array_values = trace_array_values(record.entry_point, record.args);
+    std::size_t param_count = entry_point_param_count(record.entry_point);
+    if (array_values > 0 && record.args[param_count - 1] != 0) {
+        if (record.array_bytes != array_values * sizeof(std::uint32_t)) {
+            ++replay_stats.skipped_calls;
+            return;
+        }
+        array_buffer.resize(array_values);
+        std::memcpy(array_buffer.data(), record.array, record.array_bytes);
+        array = array_buffer.data();
+    }
+
+    handler(context, record, array);
+    ++replay_stats.calls;
+}
+
+const std::vector<TraceUniform>* TraceReplay::current_uniforms(GLuint program) {
+    auto it = reflections.find(reflection_key(program, links[program]));
+    return it != reflections.end() ? &it->second : nullptr;
+}
+
+// Uniforms are named after their index, so their location can be found again.
+void TraceReplay::get_active_uniform(GLuint program, GLuint index, GLsizei buf_size, GLsizei* length, GLint* size, GLenum* type,
+                                     GLchar* name) {
+    const std::vector<TraceUniform>* uniforms = t_replay ? t_replay->current_uniforms(program) : nullptr;
+    if (!uniforms || index >= uniforms->size()) return;
+
+    *length = std::snprintf(name, static_cast<std::size_t>(buf_size), "%u", index);
+    *size = (*uniforms)[index].array_size;
+    *type = (*uniforms)[index].type;
+}
+
+GLint TraceReplay::get_uniform_location(GLuint program, const GLchar* name) {
+    const std::vector<TraceUniform>* uniforms = t_replay ? t_replay->current_uniforms(program) : nullptr;
+    auto index = static_cast<std::size_t>(std::strtoul(name, nullptr, 10));
+    if (!uniforms || index >= uniforms->size()) return -1;
+    return (*uniforms)[index].location;
+}
+
+void TraceReplay::get_programiv(GLuint program, GLenum pname, GLint* params) {
+    *params = 0;
+    if (!t_replay) return;
+
+    const std::vector<TraceUniform>* uniforms = t_replay->current_uniforms(program);
+    if (pname == GL_ACTIVE_UNIFORMS) {
+        if (!uniforms) ++t_replay->replay_stats.missing_reflections;
+        *params = uniforms ? static_cast<GLint>(uniforms->size()) : 0;
+    } else if (pname == GL_ACTIVE_UNIFORM_MAX_LENGTH) {
+        // Long enough for any index.
+        *params = 16;
+    }
+}
+
+}
@@ -8,80 +8,154 @@ void Context::glCompileShader(GLuint program) {
     // We will use glCompileShader to add shaders to our internal structure, since
     // we cannot access the return value from glCreateShader()
 
-    auto it = shaders.find(program);
-    if (it != shaders.end()) {
-        output_fmt("glCompileShader(shader = %u): Shader is already compiled.", program);
+    if (!shaders.insert(program, Shader{ program }).second) {
+        report(MessageId::ShaderAlreadyCompiled, EntryPoint::glCompileShader, { program }, program);
         return;
     }
 
-    shaders.emplace(program, Shader{ program });
+    shaders.update(program, [this](Shader& shader) { begin_pending(shader.compile_pending, &GLLayerCompileStats::compiles); });
+}
+
+void Context::glDeleteShader(GLuint shader) {
+    // Deleting shader 0 is silently ignored by OpenGL.
+    if (shader == 0) {
+        return;
+    }
+
+    bool erased = shaders.erase(shader, [this](const Shader& shader_info) {
+        bool pending = shader_info.compile_pending;
+        end_pending(pending);
+    });
+    if (erased) {
+        forget_messages(shader);
+    } else {
+        report(MessageId::InvalidShaderHandle, EntryPoint::glDeleteShader, { shader }, shader);
+    }
 }
 
 void Context::glGetShaderiv(GLuint program, GLenum param, GLint* params) {
     assert(params && "params may not be nullptr");
 
-    if (param == GL_COMPILE_STATUS) {
-        auto it = shaders.find(program);
-        if (it == shaders.end()) {
-            output_fmt("glGetShaderiv(handle = %u, param = %s, params = %p): Invalid shader handle.", program, enum_str(param), static_cast<void*>(params));
+    if (param == GL_COMPILE_STATUS || param == GL_COMPLETION_STATUS_KHR) {
+        auto guard = share_group->read();
+        const Shader* shader = shaders.find(program);
+        if (!shader) {
+            report(MessageId::InvalidShaderHandle, EntryPoint::glGetShaderiv, { program }, program, param, params);
             return;
         }
 
-        it->second.compile_status = static_cast<CompileStatus>(*params);
+        if (param == GL_COMPLETION_STATUS_KHR) {
+            // Polling for completion is how parallel compilation is meant to be used, it does not count as checking the status.
+            count_completion_poll();
+            if (*params && shader->compile_pending) {
+                shaders.update(program, [this](Shader& shader_info) { end_pending(shader_info.compile_pending); });
+            }
+            return;
+        }
+
+        // Querying the compile status waits for the compile to finish. Repeated queries change nothing, skip the update.
+        auto status = static_cast<CompileStatus>(*params);
+        if (shader->compile_pending || shader->compile_status != status) {
+            shaders.update(program, [this, status](Shader& shader_info) {
+                end_pending(shader_info.compile_pending);
+                shader_info.compile_status = status;
+            });
+        }
     }
 }
 
 void Context::glAttachShader(GLuint program, GLuint shader) {
-    // Make sure compile status was checked and successful when attaching a shader.
-    auto it = shaders.find(shader);
-    if (it == shaders.end()) {
-        output_fmt("glAttachShader(program = %u, shader = %u): Invalid shader handle.", program, shader);
-        return;
-    }
-
-    if (it->second.compile_status == CompileStatus::UNCHECKED) {
-        output_fmt("glAttachShader(program = %u, shader = %u): Always check shader compilation status before trying to use the object.", program, shader);
-    } else if (it->second.compile_status == CompileStatus::FAILED) {
-        output_fmt("glAttachShader(program = %u, shader = %u): Attached shader has a compilation error.", program, shader);
+    auto guard = share_group->read();
+
+    // Make sure compile status was checked and successful when attaching a shader. Shaders are not tracked while their
+    // rule is disabled, so there is nothing to check then.
+    if constexpr (rule_compiled(GL_LAYER_RULE_SHADER_COMPILE)) {
+        if (rule_enabled(GL_LAYER_RULE_SHADER_COMPILE)) {
+            const Shader* shader_info = shaders.find(shader);
+            if (!shader_info) {
+                report(MessageId::InvalidShaderHandle, EntryPoint::glAttachShader, { shader, program }, program, shader);
+                return;
+            }
+
+            if (shader_info->compile_status == CompileStatus::UNCHECKED) {
+                report(MessageId::ShaderCompileStatusUnchecked, EntryPoint::glAttachShader, { shader, program }, program, shader);
+            } else if (shader_info->compile_status == CompileStatus::FAILED) {
+                report(MessageId::ShaderCompileFailed, EntryPoint::glAttachShader, { shader, program }, program, shader);
+            }
+        }
     }
 
     // We will also use glAttachShader to create and manage program variables, as we cannot use glCreateProgram for this.
-    auto program_it = programs.find(program);
-    if (program_it == programs.end()) {
-        // This is the first time this program gets a shader attached, create a new one.
-        Program prog = { program, { shader } };
-        programs.insert({ program, std::move(prog) });
-    } else {
-        // Program already has an attached shader, add this one as well
-        program_it->second.shaders.push_back(shader);
-    }
+    programs.insert(program, Program{ program });
+    // If this is not the first time this program gets a shader attached, this adds the shader to the existing ones.
+    programs.update(program, [shader](Program& program_info) { program_info.shaders.push_back(shader); });
 }
 
 void Context::glGetProgramiv(GLuint program, GLenum param, GLint* params) {
     assert(params && "params may not be nullptr");
 
-    if (param == GL_LINK_STATUS) {
-        auto it = programs.find(program);
-        if (it == programs.end()) {
-            output_fmt("glGetProgramiv(handle = %u, param = %s, params = %p): Invalid program handle.", program, enum_str(param), static_cast<void*>(params));
+    if (param == GL_LINK_STATUS || param == GL_COMPLETION_STATUS_KHR) {
+        auto guard = share_group->read();
+        const Program* program_info = programs.find(program);
+        if (!program_info) {
+            report(MessageId::InvalidProgramHandle, EntryPoint::glGetProgramiv, { program }, program, param, params);
             return;
         }
 
-        it->second.link_status = static_cast<LinkStatus>(*params);
+        if (param == GL_COMPLETION_STATUS_KHR) {
+            count_completion_poll();
+            if (*params && program_info->link_pending) {
+                programs.update(program, [this](Program& info) { end_pending(info.link_pending); });
+            }
+            return;
+        }
+
+        auto status = static_cast<LinkStatus>(*params);
+        if (program_info->link_pending || program_info->link_status != status) {
+            programs.update(program, [this, status](Program& info) {
+                end_pending(info.link_pending);
+                info.link_status = status;
+            });
+        }
     }
 }
 
 void Context::glLinkProgram(GLuint program)
 {
-    auto program_it = programs.find(program);
-    if (program_it == programs.end()) {
-        output_fmt("glLinkProgram(program = %u): Invalid program handle.", program);
+    // Reflection is deferred until the program is used, see reflect_uniforms().
+    UniformWrites unlinked_writes;
+    const Program* program_info = programs.update(program, [this, &unlinked_writes](Program& info) {
+        info.uniforms.assign({});
+        info.uniforms_reflected = false;
+        unlinked_writes = std::exchange(info.uniform_writes, UniformWrites{});
+        info.uniform_values.reset();
+        begin_pending(info.link_pending, &GLLayerCompileStats::links);
+    });
+    // Released once the program without them is published, readers of the old program may still write them.
+    unlinked_writes.release(uniform_bitsets, programs.is_concurrent());
+    if (!program_info) {
+        report(MessageId::InvalidProgramHandle, EntryPoint::glLinkProgram, { program }, program);
+    }
+}
+
+// Programs are only reflected when they are used. Using a program makes the driver finish linking it anyway, so a
+// program that was relinked after its link status was checked is reflected even if the new status was never queried.
+static bool needs_reflection(const Program& program_info) {
+    return !program_info.uniforms_reflected && program_info.link_status == LinkStatus::OK;
+}
+
+void Context::reflect_uniforms(const Program& program_info) {
+    if (!needs_reflection(program_info)) {
         return;
     }
 
-    auto& program_info = program_it->second;
+    GLuint program = program_info.handle;
+    if (program_info.link_pending) {
+        programs.update(program, [this](Program& info) { end_pending(info.link_pending); });
+    }
 
     // Store all active uniforms in the program (location, array size, and type)
+    std::vector<std::pair<GLint, UniformInfo>> uniforms;
     GLint uniform_count{};
     gl.GetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniform_count);
     if (uniform_count > 0)
@@ -106,65 +180,171 @@ void Context::glLinkProgram(GLuint program)
 
             auto loc = gl.GetUniformLocation(program, uniform_name.get());
 
-            program_info.uniforms.emplace(loc, uniform_info);
+            uniforms.emplace_back(loc, uniform_info);
+
+            // Only the first element of an array is listed. The others follow at consecutive locations, which is what
+            // drivers do and what explicit locations require.
+            for (GLint element = 1; loc >= 0 && element < uniform_info.array_size; ++element) {
+                uniforms.emplace_back(loc + element, UniformInfo{ uniform_info.array_size - element, uniform_info.type, true });
+            }
+        }
+    }
+
+    // A replay of the trace answers the queries with what the driver answered here.
+    if (trace) {
+        std::vector<TraceUniform> active;
+        for (const auto& [location, info] : uniforms) {
+            if (!info.array_element) active.push_back(TraceUniform{ location, info.array_size, info.type });
         }
+        trace->record_program_uniforms(program, active.data(), active.size());
     }
+
+    // The driver is queried without holding a lock. If another context relinked or reflected the program meanwhile,
+    // its state wins.
+    programs.update(program, [this, &uniforms](Program& info) {
+        if (needs_reflection(info) && !info.link_pending) {
+            info.uniforms.assign(std::move(uniforms));
+            info.uniforms_reflected = true;
+            if constexpr (rule_compiled(GL_LAYER_RULE_DRAW_STATE)) {
+                info.uniform_writes = UniformWrites::create(uniform_bitsets, info.uniforms);
+            }
+            // Copies of the values are only kept while they are compared.
+            if constexpr (rule_compiled(GL_LAYER_RULE_REDUNDANT_UNIFORMS)) {
+                if (rule_enabled(GL_LAYER_RULE_REDUNDANT_UNIFORMS)) info.uniform_values = std::make_shared<UniformValues>(info.uniforms);
+            }
+        }
+    });
+}
+
+const Program* Context::find_reflected_program(GLuint program) {
+    const Program* program_info = programs.find(program);
+    if (program_info && needs_reflection(*program_info)) {
+        reflect_uniforms(*program_info);
+        program_info = programs.find(program);
+    }
+    return program_info;
 }
 
 void Context::glUseProgram(GLuint program) {
-    if (program == 0) {
-        current_program_handle = 0;
-        return;
+    // Binding the program that is already bound is harmless, but still costs a driver call. Such binds are only counted,
+    // and reported per frame.
+    if constexpr (rule_compiled(GL_LAYER_RULE_REDUNDANT_STATE)) {
+        if (rule_enabled(GL_LAYER_RULE_REDUNDANT_STATE)) {
+            count_program_bind(program);
+        }
     }
 
-    if (!validate_program_status(program)) {
+    if (program == 0) {
+        bind_program(0);
         return;
     }
 
-    // TODO: add optional performance warning for rebinding the same program
-    //if (handle == current_program_handle) {
-    //    output_fmt("glUseProgram(program = %u): Program is already bound.", handle);
-    //}
+    // With only the program bound rule enabled, programs are not tracked and only the binding matters. Calls that are
+    // not sampled only need the binding as well. Rebinding the program that passed the checks last time, with no program
+    // changed since, would pass them again.
+    if constexpr (rule_compiled(GL_LAYER_RULE_PROGRAM_LINK)) {
+        if (sampled && rule_enabled(GL_LAYER_RULE_PROGRAM_LINK)) {
+            std::uint64_t changes = programs.changes_count();
+            if (program != current_program_handle || program != validated_program || changes != validated_program_changes) {
+                auto guard = share_group->read();
+                const Program* program_info = validate_program_status(program);
+                if (!program_info) {
+                    validated_program = 0;
+                    return;
+                }
+
+                reflect_uniforms(*program_info);
+                validated_program = program;
+                validated_program_changes = changes;
+            }
+        }
+    }
 
-    current_program_handle = program;
+    bind_program(program);
 }
 
 void Context::glDeleteProgram(GLuint program) {
-    auto it = programs.find(program);
-    if (it == programs.end()) {
-        output_fmt("glUseProgram(program = %u): Invalid program handle.", program);
+    // Deleting program 0 is silently ignored by OpenGL.
+    if (program == 0) {
         return;
     }
 
     // note: this does not change which program is bound, even if it becomes invalid here
-
-    programs.erase(it);
+    UniformWrites deleted_writes;
+    bool erased = programs.erase(program, [this, &deleted_writes](const Program& program_info) {
+        bool pending = program_info.link_pending;
+        end_pending(pending);
+        deleted_writes = program_info.uniform_writes;
+    });
+    deleted_writes.release(uniform_bitsets, programs.is_concurrent());
+    if (erased) {
+        forget_messages(program);
+    } else {
+        report(MessageId::InvalidProgramHandle, EntryPoint::glDeleteProgram, { program }, program);
+    }
 }
 
-void Context::validate_program_bound(std::string_view func_name) {
+bool Context::validate_program_bound(EntryPoint entry_point) {
     if (current_program_handle == 0) {
-        output_fmt("%s: No program bound.", func_name.data());
-        return;
+        report(MessageId::NoProgramBound, entry_point, {});
+        return false;
     }
+    return true;
 }
 
-bool Context::validate_program_status(GLuint program) {
-    auto it = programs.find(program);
-    if (it == programs.end()) {
-        output_fmt("glUseProgram(program = %u): Invalid program handle.", program);
-        return false;
+const Program* Context::validate_program_status(GLuint program, EntryPoint entry_point) {
+    const Program* program_info = programs.find(program);
+    if (!program_info) {
+        report(MessageId::InvalidProgramHandle, entry_point, { program }, program);
+        return nullptr;
     }
 
-    if (it->second.link_status == LinkStatus::UNCHECKED) {
-        output_fmt("glUseProgram(program = %u): Always check program link status before trying to use the object.", program);
-        return false;
+    if (program_info->link_status == LinkStatus::UNCHECKED) {
+        report(MessageId::ProgramLinkStatusUnchecked, entry_point, { program }, program);
+        return nullptr;
     }
 
-    if (it->second.link_status == LinkStatus::FAILED) {
-        output_fmt("glUseProgram(program = %u): Program has a linker error.", program);
-        return false;
+    if (program_info->link_status == LinkStatus::FAILED) {
+        report(MessageId::ProgramLinkFailed, entry_point, { program }, program);
+        return nullptr;
     }
 
-    return true;
+    return program_info;
+}
+
+// Compile statistics are shared by the contexts of a share group, pending flags are only changed through
+// ObjectTable::update().
+void Context::begin_pending(bool& pending, unsigned int GLLayerCompileStats::*started) {
+    std::lock_guard<std::mutex> lock(share_group->stats_mutex);
+    GLLayerCompileStats& compile_stats = share_group->compile_stats;
+    ++(compile_stats.*started);
+    if (pending) {
+        // Compiled or linked again before the previous one was observed, it is still the same single job in flight.
+        return;
+    }
+
+    if (compile_stats.in_flight > 0) {
+        ++compile_stats.overlapped;
+    }
+    pending = true;
+    ++compile_stats.in_flight;
+    if (compile_stats.in_flight > compile_stats.max_in_flight) {
+        compile_stats.max_in_flight = compile_stats.in_flight;
+    }
+}
+
+void Context::end_pending(bool& pending) {
+    if (!pending) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(share_group->stats_mutex);
+    pending = false;
+    --share_group->compile_stats.in_flight;
+}
+
+void Context::count_completion_poll() {
+    std::lock_guard<std::mutex> lock(share_group->stats_mutex);
+    ++share_group->compile_stats.completion_polls;
 }
 }
\ No newline at end of file
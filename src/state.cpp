@@ -0,0 +1,74 @@
+#include <gl_layer/context.h>
+#include <gl_layer/private/context.h>
+
+namespace gl_layer {
+
+// These functions keep the shadow state up to date on every call, sampled or not, and count the calls that did not change
+// anything.
+
+void Context::glEnable(GLenum cap) {
+    count_state_change(EntryPoint::glEnable, state.set_enabled(cap, true));
+}
+
+void Context::glDisable(GLenum cap) {
+    count_state_change(EntryPoint::glDisable, state.set_enabled(cap, false));
+}
+
+void Context::glActiveTexture(GLenum texture) {
+    count_state_change(EntryPoint::glActiveTexture, state.active_texture(texture));
+}
+
+void Context::glBindTexture(GLenum target, GLuint texture) {
+    count_state_change(EntryPoint::glBindTexture, state.bind_texture(target, texture));
+}
+
+void Context::glDeleteTextures(GLsizei n, const GLuint* textures) {
+    for (GLsizei i = 0; i < n; ++i) {
+        if (textures[i] != 0) state.delete_texture(textures[i]);
+    }
+}
+
+void Context::glBindBuffer(GLenum target, GLuint buffer) {
+    count_state_change(EntryPoint::glBindBuffer, state.bind_buffer(target, buffer));
+}
+
+// Indexed bindings are not tracked, these only count as changes. They do bind the buffer to the generic binding point as
+// well, so that one stays in sync.
+void Context::glBindBufferBase(GLenum target, GLuint, GLuint buffer) {
+    state.bind_buffer(target, buffer);
+    count_state_change(EntryPoint::glBindBufferBase, false);
+}
+
+void Context::glBindBufferRange(GLenum target, GLuint, GLuint buffer, GLintptr, GLsizeiptr) {
+    state.bind_buffer(target, buffer);
+    count_state_change(EntryPoint::glBindBufferRange, false);
+}
+
+void Context::glDeleteBuffers(GLsizei n, const GLuint* buffers) {
+    for (GLsizei i = 0; i < n; ++i) {
+        if (buffers[i] != 0) state.delete_buffer(buffers[i]);
+    }
+}
+
+// The bound vertex array is also needed to validate draws.
+void Context::glBindVertexArray(GLuint array) {
+    bool redundant = state.bind_vertex_array(array);
+    count_state_change(EntryPoint::glBindVertexArray, redundant);
+    if (!redundant) ++draw_state_epoch;
+}
+
+void Context::glDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    for (GLsizei i = 0; i < n; ++i) {
+        if (arrays[i] != 0 && state.delete_vertex_array(arrays[i])) ++draw_state_epoch;
+    }
+}
+
+void Context::glBlendFunc(GLenum sfactor, GLenum dfactor) {
+    count_state_change(EntryPoint::glBlendFunc, state.blend_func(sfactor, dfactor));
+}
+
+void Context::glDepthFunc(GLenum func) {
+    count_state_change(EntryPoint::glDepthFunc, state.set_depth_func(func));
+}
+
+}
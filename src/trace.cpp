@@ -0,0 +1,137 @@
+#include <gl_layer/private/trace.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace gl_layer {
+
+std::unique_ptr<TraceWriter> TraceWriter::create(const char* path, std::uint64_t size, Version gl_version) {
+    // The oldest block is only overwritten after the next one was started, so at least two are needed to keep any calls.
+    std::uint64_t block_count = std::max<std::uint64_t>((size + trace_block_size - 1) / trace_block_size, 2);
+    std::uint64_t file_size = trace_header_size + block_count * trace_block_size;
+    if (!path || file_size > static_cast<std::uint64_t>(SIZE_MAX)) return nullptr;
+
+    std::unique_ptr<TraceWriter> writer(new TraceWriter());
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    writer->file = file;
+
+    // Mapping a larger size than the file grows it, the new bytes are zero.
+    HANDLE file_mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(file_size >> 32),
+                                             static_cast<DWORD>(file_size), nullptr);
+    if (!file_mapping) return nullptr;
+    writer->file_mapping = file_mapping;
+
+    void* mapping = MapViewOfFile(file_mapping, FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(file_size));
+    if (!mapping) return nullptr;
+#else
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return nullptr;
+
+    // Truncating first leaves a file of zeros, so blocks that were never written have sequence 0.
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(file_size)) == 0) {
+        mapping = mmap(nullptr, static_cast<std::size_t>(file_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) return nullptr;
+#endif
+
+    writer->mapping = static_cast<unsigned char*>(mapping);
+    writer->mapping_size = static_cast<std::size_t>(file_size);
+    writer->block_count = block_count;
+
+    TraceFileHeader header{};
+    std::memcpy(header.magic, trace_magic, sizeof(header.magic));
+    header.version = trace_version;
+    header.block_size = static_cast<std::uint32_t>(trace_block_size);
+    header.block_count = block_count;
+    header.gl_version_major = gl_version.major;
+    header.gl_version_minor = gl_version.minor;
+    std::memcpy(writer->mapping, &header, sizeof(header));
+
+    writer->next_block();
+    return writer;
+}
+
+TraceWriter::~TraceWriter() {
+#ifdef _WIN32
+    if (mapping) UnmapViewOfFile(mapping);
+    if (file_mapping) CloseHandle(file_mapping);
+    if (file) CloseHandle(file);
+#else
+    // Unmapping leaves the pages to the page cache, the kernel writes them back.
+    if (mapping) munmap(mapping, mapping_size);
+#endif
+}
+
+void TraceWriter::next_block() {
+    block = mapping + trace_header_size + (sequence % block_count) * trace_block_size;
+    position = block + sizeof(TraceBlockHeader);
+    block_end = block + trace_block_size;
+    std::memset(last_args, 0, sizeof(last_args));
+
+    // Empty the block before it gets its new sequence number, so it never holds records of another block.
+    TraceBlockHeader header{};
+    std::memcpy(block, &header, sizeof(header));
+    std::atomic_signal_fence(std::memory_order_release);
+    header.sequence = ++sequence;
+    std::memcpy(block, &header, sizeof(header));
+}
+
+bool TraceReader::open(const char* path) {
+    data.clear();
+    block_offsets.clear();
+    first_sequence = 0;
+
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+
+    unsigned char buffer[64 * 1024];
+    std::size_t count;
+    while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + count);
+    }
+    std::fclose(file);
+
+    TraceFileHeader header;
+    if (data.size() < trace_header_size) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, trace_magic, sizeof(trace_magic)) != 0 || header.version != trace_version ||
+        header.block_size <= sizeof(TraceBlockHeader) || header.block_count > (data.size() - trace_header_size) / header.block_size) {
+        return false;
+    }
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> blocks;
+    for (std::uint64_t i = 0; i < header.block_count; ++i) {
+        std::size_t offset = trace_header_size + static_cast<std::size_t>(i) * header.block_size;
+        TraceBlockHeader block;
+        std::memcpy(&block, data.data() + offset, sizeof(block));
+        if (block.sequence == 0 || block.used > header.block_size - sizeof(TraceBlockHeader)) continue;
+        blocks.emplace_back(block.sequence, offset);
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+    for (const auto& block : blocks) block_offsets.push_back(block.second);
+    if (!blocks.empty()) first_sequence = blocks.front().first;
+    version = Version{ header.gl_version_major, header.gl_version_minor };
+    return true;
+}
+
+}
@@ -0,0 +1,381 @@
+#include <gl_layer/context.h>
+#include <gl_layer/private/context.h>
+
+#include <algorithm>
+
+namespace gl_layer {
+
+namespace {
+
+// Setting more elements than are left in an array is fine, the rest is ignored.
+bool uniform_count_valid(GLsizei count, const UniformInfo& info) {
+    return count >= 0 && (count <= 1 || info.array_size > 1 || info.array_element);
+}
+
+}
+
+// glUniform is the most frequently called function the layer validates, a valid call costs a program lookup, a uniform
+// lookup and a few compares. Writes and uploaded values are recorded on every call, sampled or not, so a sampled draw
+// does not miss a uniform set by an unsampled call. Arrays of count elements take count consecutive locations. values
+// points to the uploaded values.
+template<typename... Args>
+void Context::set_uniform(EntryPoint entry_point, GLuint program, GLenum set_type, GLint location, GLsizei count, const void* values,
+                          Args... args) {
+    // Location -1 is silently ignored by OpenGL.
+    constexpr std::uint32_t program_rules = GL_LAYER_RULE_DRAW_STATE | GL_LAYER_RULE_UNIFORM | GL_LAYER_RULE_REDUNDANT_UNIFORMS;
+    if (location == -1 || !rule_enabled(program_rules)) {
+        return;
+    }
+
+    auto guard = share_group->read();
+    const Program* program_info = find_reflected_program(program);
+    if (!program_info) {
+        // An invalid bound program was already reported by glUseProgram.
+        if (program != current_program_handle) {
+            report(MessageId::InvalidProgramHandle, entry_point, { program }, args...);
+        }
+        return;
+    }
+
+    // Programs that were not successfully linked, or not checked, are reported when they are used.
+    if (!program_info->uniforms_reflected) {
+        return;
+    }
+
+    const UniformInfo* info = program_info->uniforms.find(location);
+    if constexpr (rule_compiled(GL_LAYER_RULE_UNIFORM)) {
+        if (sampled && rule_enabled(GL_LAYER_RULE_UNIFORM)) {
+            if (!info) {
+                report(MessageId::InvalidUniformLocation, entry_point, { program }, args...);
+                return;
+            }
+            if (!uniform_type_compatible(set_type, info->type)) {
+                report(MessageId::UniformTypeMismatch, entry_point, { program }, args...);
+                return;
+            }
+            if (!uniform_count_valid(count, *info)) {
+                report(MessageId::InvalidUniformCount, entry_point, { program }, args...);
+                return;
+            }
+        }
+    }
+
+    if constexpr (rule_compiled(GL_LAYER_RULE_REDUNDANT_UNIFORMS)) {
+        if (rule_enabled(GL_LAYER_RULE_REDUNDANT_UNIFORMS) && info && program_info->uniform_values) {
+            std::size_t redundant_bytes = program_info->uniform_values->upload(location, *info, values, count, uniform_value_size(set_type),
+                                                                               programs.is_concurrent());
+            count_uniform_upload(program, redundant_bytes);
+        }
+    }
+
+    // Only the first write of a uniform can change the outcome of draw validation. OpenGL rejects calls that do not fit
+    // the uniform, those write nothing, and an array is only written up to its end. This is checked again here, the
+    // uniform rule that reports those calls may be disabled.
+    if constexpr (rule_compiled(GL_LAYER_RULE_DRAW_STATE)) {
+        if (rule_enabled(GL_LAYER_RULE_DRAW_STATE) && info && uniform_type_compatible(set_type, info->type) &&
+            uniform_count_valid(count, *info)) {
+            GLsizei written = std::min<GLsizei>(count, std::max<GLint>(info->array_size, 1));
+            if (program_info->uniform_writes.write(uniform_bitsets, location, written)) ++draw_state_epoch;
+        }
+    }
+}
+
+template<typename... Args>
+void Context::set_bound_uniform(EntryPoint entry_point, GLenum set_type, GLint location, GLsizei count, const void* values,
+                                Args... args) {
+    if (current_program_handle == 0) {
+        validate_program_bound(entry_point);
+        return;
+    }
+    set_uniform(entry_point, current_program_handle, set_type, location, count, values, args...);
+}
+
+void Context::glUniform1f(GLint location, GLfloat v0) {
+    const GLfloat values[] = { v0 };
+    set_bound_uniform(EntryPoint::glUniform1f, GL_FLOAT, location, 1, values, location, v0);
+}
+
+void Context::glUniform2f(GLint location, GLfloat v0, GLfloat v1) {
+    const GLfloat values[] = { v0, v1 };
+    set_bound_uniform(EntryPoint::glUniform2f, GL_FLOAT_VEC2, location, 1, values, location, v0, v1);
+}
+
+void Context::glUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+    const GLfloat values[] = { v0, v1, v2 };
+    set_bound_uniform(EntryPoint::glUniform3f, GL_FLOAT_VEC3, location, 1, values, location, v0, v1, v2);
+}
+
+void Context::glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+    const GLfloat values[] = { v0, v1, v2, v3 };
+    set_bound_uniform(EntryPoint::glUniform4f, GL_FLOAT_VEC4, location, 1, values, location, v0, v1, v2, v3);
+}
+
+void Context::glUniform1i(GLint location, GLint v0) {
+    const GLint values[] = { v0 };
+    set_bound_uniform(EntryPoint::glUniform1i, GL_INT, location, 1, values, location, v0);
+}
+
+void Context::glUniform2i(GLint location, GLint v0, GLint v1) {
+    const GLint values[] = { v0, v1 };
+    set_bound_uniform(EntryPoint::glUniform2i, GL_INT_VEC2, location, 1, values, location, v0, v1);
+}
+
+void Context::glUniform3i(GLint location, GLint v0, GLint v1, GLint v2) {
+    const GLint values[] = { v0, v1, v2 };
+    set_bound_uniform(EntryPoint::glUniform3i, GL_INT_VEC3, location, 1, values, location, v0, v1, v2);
+}
+
+void Context::glUniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
+    const GLint values[] = { v0, v1, v2, v3 };
+    set_bound_uniform(EntryPoint::glUniform4i, GL_INT_VEC4, location, 1, values, location, v0, v1, v2, v3);
+}
+
+void Context::glUniform1ui(GLint location, GLuint v0) {
+    const GLuint values[] = { v0 };
+    set_bound_uniform(EntryPoint::glUniform1ui, GL_UNSIGNED_INT, location, 1, values, location, v0);
+}
+
+void Context::glUniform2ui(GLint location, GLuint v0, GLuint v1) {
+    const GLuint values[] = { v0, v1 };
+    set_bound_uniform(EntryPoint::glUniform2ui, GL_UNSIGNED_INT_VEC2, location, 1, values, location, v0, v1);
+}
+
+void Context::glUniform3ui(GLint location, GLuint v0, GLuint v1, GLuint v2) {
+    const GLuint values[] = { v0, v1, v2 };
+    set_bound_uniform(EntryPoint::glUniform3ui, GL_UNSIGNED_INT_VEC3, location, 1, values, location, v0, v1, v2);
+}
+
+void Context::glUniform4ui(GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3) {
+    const GLuint values[] = { v0, v1, v2, v3 };
+    set_bound_uniform(EntryPoint::glUniform4ui, GL_UNSIGNED_INT_VEC4, location, 1, values, location, v0, v1, v2, v3);
+}
+
+void Context::glUniform1fv(GLint location, GLsizei count, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniform1fv, GL_FLOAT, location, count, value, location, count, value);
+}
+
+void Context::glUniform2fv(GLint location, GLsizei count, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniform2fv, GL_FLOAT_VEC2, location, count, value, location, count, value);
+}
+
+void Context::glUniform3fv(GLint location, GLsizei count, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniform3fv, GL_FLOAT_VEC3, location, count, value, location, count, value);
+}
+
+void Context::glUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniform4fv, GL_FLOAT_VEC4, location, count, value, location, count, value);
+}
+
+void Context::glUniform1iv(GLint location, GLsizei count, const GLint* value) {
+    set_bound_uniform(EntryPoint::glUniform1iv, GL_INT, location, count, value, location, count, value);
+}
+
+void Context::glUniform2iv(GLint location, GLsizei count, const GLint* value) {
+    set_bound_uniform(EntryPoint::glUniform2iv, GL_INT_VEC2, location, count, value, location, count, value);
+}
+
+void Context::glUniform3iv(GLint location, GLsizei count, const GLint* value) {
+    set_bound_uniform(EntryPoint::glUniform3iv, GL_INT_VEC3, location, count, value, location, count, value);
+}
+
+void Context::glUniform4iv(GLint location, GLsizei count, const GLint* value) {
+    set_bound_uniform(EntryPoint::glUniform4iv, GL_INT_VEC4, location, count, value, location, count, value);
+}
+
+void Context::glUniform1uiv(GLint location, GLsizei count, const GLuint* value) {
+    set_bound_uniform(EntryPoint::glUniform1uiv, GL_UNSIGNED_INT, location, count, value, location, count, value);
+}
+
+void Context::glUniform2uiv(GLint location, GLsizei count, const GLuint* value) {
+    set_bound_uniform(EntryPoint::glUniform2uiv, GL_UNSIGNED_INT_VEC2, location, count, value, location, count, value);
+}
+
+void Context::glUniform3uiv(GLint location, GLsizei count, const GLuint* value) {
+    set_bound_uniform(EntryPoint::glUniform3uiv, GL_UNSIGNED_INT_VEC3, location, count, value, location, count, value);
+}
+
+void Context::glUniform4uiv(GLint location, GLsizei count, const GLuint* value) {
+    set_bound_uniform(EntryPoint::glUniform4uiv, GL_UNSIGNED_INT_VEC4, location, count, value, location, count, value);
+}
+
+void Context::glUniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix2fv, GL_FLOAT_MAT2, location, count, value, location, count, transpose, value);
+}
+
+void Context::glUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix3fv, GL_FLOAT_MAT3, location, count, value, location, count, transpose, value);
+}
+
+void Context::glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix4fv, GL_FLOAT_MAT4, location, count, value, location, count, transpose, value);
+}
+
+void Context::glUniformMatrix2x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix2x3fv, GL_FLOAT_MAT2x3, location, count, value, location, count, transpose, value);
+}
+
+void Context::glUniformMatrix3x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix3x2fv, GL_FLOAT_MAT3x2, location, count, value, location, count, transpose, value);
+}
+
+void Context::glUniformMatrix2x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix2x4fv, GL_FLOAT_MAT2x4, location, count, value, location, count, transpose, value);
+}
+
+void Context::glUniformMatrix4x2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix4x2fv, GL_FLOAT_MAT4x2, location, count, value, location, count, transpose, value);
+}
+
+void Context::glUniformMatrix3x4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix3x4fv, GL_FLOAT_MAT3x4, location, count, value, location, count, transpose, value);
+}
+
+void Context::glUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_bound_uniform(EntryPoint::glUniformMatrix4x3fv, GL_FLOAT_MAT4x3, location, count, value, location, count, transpose, value);
+}
+
+void Context::glProgramUniform1f(GLuint program, GLint location, GLfloat v0) {
+    const GLfloat values[] = { v0 };
+    set_uniform(EntryPoint::glProgramUniform1f, program, GL_FLOAT, location, 1, values, program, location, v0);
+}
+
+void Context::glProgramUniform2f(GLuint program, GLint location, GLfloat v0, GLfloat v1) {
+    const GLfloat values[] = { v0, v1 };
+    set_uniform(EntryPoint::glProgramUniform2f, program, GL_FLOAT_VEC2, location, 1, values, program, location, v0, v1);
+}
+
+void Context::glProgramUniform3f(GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+    const GLfloat values[] = { v0, v1, v2 };
+    set_uniform(EntryPoint::glProgramUniform3f, program, GL_FLOAT_VEC3, location, 1, values, program, location, v0, v1, v2);
+}
+
+void Context::glProgramUniform4f(GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+    const GLfloat values[] = { v0, v1, v2, v3 };
+    set_uniform(EntryPoint::glProgramUniform4f, program, GL_FLOAT_VEC4, location, 1, values, program, location, v0, v1, v2, v3);
+}
+
+void Context::glProgramUniform1i(GLuint program, GLint location, GLint v0) {
+    const GLint values[] = { v0 };
+    set_uniform(EntryPoint::glProgramUniform1i, program, GL_INT, location, 1, values, program, location, v0);
+}
+
+void Context::glProgramUniform2i(GLuint program, GLint location, GLint v0, GLint v1) {
+    const GLint values[] = { v0, v1 };
+    set_uniform(EntryPoint::glProgramUniform2i, program, GL_INT_VEC2, location, 1, values, program, location, v0, v1);
+}
+
+void Context::glProgramUniform3i(GLuint program, GLint location, GLint v0, GLint v1, GLint v2) {
+    const GLint values[] = { v0, v1, v2 };
+    set_uniform(EntryPoint::glProgramUniform3i, program, GL_INT_VEC3, location, 1, values, program, location, v0, v1, v2);
+}
+
+void Context::glProgramUniform4i(GLuint program, GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
+    const GLint values[] = { v0, v1, v2, v3 };
+    set_uniform(EntryPoint::glProgramUniform4i, program, GL_INT_VEC4, location, 1, values, program, location, v0, v1, v2, v3);
+}
+
+void Context::glProgramUniform1ui(GLuint program, GLint location, GLuint v0) {
+    const GLuint values[] = { v0 };
+    set_uniform(EntryPoint::glProgramUniform1ui, program, GL_UNSIGNED_INT, location, 1, values, program, location, v0);
+}
+
+void Context::glProgramUniform2ui(GLuint program, GLint location, GLuint v0, GLuint v1) {
+    const GLuint values[] = { v0, v1 };
+    set_uniform(EntryPoint::glProgramUniform2ui, program, GL_UNSIGNED_INT_VEC2, location, 1, values, program, location, v0, v1);
+}
+
+void Context::glProgramUniform3ui(GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2) {
+    const GLuint values[] = { v0, v1, v2 };
+    set_uniform(EntryPoint::glProgramUniform3ui, program, GL_UNSIGNED_INT_VEC3, location, 1, values, program, location, v0, v1, v2);
+}
+
+void Context::glProgramUniform4ui(GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3) {
+    const GLuint values[] = { v0, v1, v2, v3 };
+    set_uniform(EntryPoint::glProgramUniform4ui, program, GL_UNSIGNED_INT_VEC4, location, 1, values, program, location, v0, v1, v2, v3);
+}
+
+void Context::glProgramUniform1fv(GLuint program, GLint location, GLsizei count, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniform1fv, program, GL_FLOAT, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform2fv(GLuint program, GLint location, GLsizei count, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniform2fv, program, GL_FLOAT_VEC2, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform3fv(GLuint program, GLint location, GLsizei count, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniform3fv, program, GL_FLOAT_VEC3, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform4fv(GLuint program, GLint location, GLsizei count, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniform4fv, program, GL_FLOAT_VEC4, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform1iv(GLuint program, GLint location, GLsizei count, const GLint* value) {
+    set_uniform(EntryPoint::glProgramUniform1iv, program, GL_INT, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform2iv(GLuint program, GLint location, GLsizei count, const GLint* value) {
+    set_uniform(EntryPoint::glProgramUniform2iv, program, GL_INT_VEC2, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform3iv(GLuint program, GLint location, GLsizei count, const GLint* value) {
+    set_uniform(EntryPoint::glProgramUniform3iv, program, GL_INT_VEC3, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform4iv(GLuint program, GLint location, GLsizei count, const GLint* value) {
+    set_uniform(EntryPoint::glProgramUniform4iv, program, GL_INT_VEC4, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform1uiv(GLuint program, GLint location, GLsizei count, const GLuint* value) {
+    set_uniform(EntryPoint::glProgramUniform1uiv, program, GL_UNSIGNED_INT, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform2uiv(GLuint program, GLint location, GLsizei count, const GLuint* value) {
+    set_uniform(EntryPoint::glProgramUniform2uiv, program, GL_UNSIGNED_INT_VEC2, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform3uiv(GLuint program, GLint location, GLsizei count, const GLuint* value) {
+    set_uniform(EntryPoint::glProgramUniform3uiv, program, GL_UNSIGNED_INT_VEC3, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniform4uiv(GLuint program, GLint location, GLsizei count, const GLuint* value) {
+    set_uniform(EntryPoint::glProgramUniform4uiv, program, GL_UNSIGNED_INT_VEC4, location, count, value, program, location, count, value);
+}
+
+void Context::glProgramUniformMatrix2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix2fv, program, GL_FLOAT_MAT2, location, count, value, program, location, count, transpose, value);
+}
+
+void Context::glProgramUniformMatrix3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix3fv, program, GL_FLOAT_MAT3, location, count, value, program, location, count, transpose, value);
+}
+
+void Context::glProgramUniformMatrix4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix4fv, program, GL_FLOAT_MAT4, location, count, value, program, location, count, transpose, value);
+}
+
+void Context::glProgramUniformMatrix2x3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix2x3fv, program, GL_FLOAT_MAT2x3, location, count, value, program, location, count, transpose, value);
+}
+
+void Context::glProgramUniformMatrix3x2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix3x2fv, program, GL_FLOAT_MAT3x2, location, count, value, program, location, count, transpose, value);
+}
+
+void Context::glProgramUniformMatrix2x4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix2x4fv, program, GL_FLOAT_MAT2x4, location, count, value, program, location, count, transpose, value);
+}
+
+void Context::glProgramUniformMatrix4x2fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix4x2fv, program, GL_FLOAT_MAT4x2, location, count, value, program, location, count, transpose, value);
+}
+
+void Context::glProgramUniformMatrix3x4fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix3x4fv, program, GL_FLOAT_MAT3x4, location, count, value, program, location, count, transpose, value);
+}
+
+void Context::glProgramUniformMatrix4x3fv(GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) {
+    set_uniform(EntryPoint::glProgramUniformMatrix4x3fv, program, GL_FLOAT_MAT4x3, location, count, value, program, location, count, transpose, value);
+}
+
+}
@@ -0,0 +1,678 @@
+// Headless microbenchmarks for the validation layer. These do not need an OpenGL context, the layer is driven
+// directly through its public entry points with stubbed out driver functions.
+
+#include <gl_layer/context.h>
+#include <gl_layer/private/entry_points.h>
+#include <gl_layer/private/object_table.h>
+#include <gl_layer/private/replay.h>
+#include <gl_layer/private/trace.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+volatile std::size_t sink = 0;
+
+template<typename F>
+void bench(const char* name, std::size_t iterations, F&& f) {
+    // Warm up caches and branch predictors before measuring.
+    for (std::size_t i = 0; i < iterations / 10; ++i) f(i);
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) f(i);
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+    std::printf("%-56s %8.2f ns/op\n", name, ns);
+}
+
+// Program 3 has 8 vec4 uniforms, u0 to u7 at locations 0 to 7. Every other program has none.
+constexpr unsigned int uniform_program = 3;
+
+void stub_get_active_uniform(unsigned, unsigned index, int, int* length, int* size, unsigned* type, char* name) {
+    *length = std::snprintf(name, 8, "u%u", index);
+    *size = 1;
+    *type = 0x8B52; // GL_FLOAT_VEC4
+}
+
+int stub_get_uniform_location(unsigned, const char* name) {
+    return std::atoi(name + 1);
+}
+
+void stub_get_programiv(unsigned program, unsigned pname, int* params) {
+    bool uniforms = program == uniform_program && (pname == 0x8B86 /* GL_ACTIVE_UNIFORMS */ || pname == 0x8B87 /* GL_ACTIVE_UNIFORM_MAX_LENGTH */);
+    *params = uniforms ? 8 : 0;
+}
+
+void discard_output(const char*, void*) {}
+
+// Builds a table of `N` synthetic entry point names, to show lookup cost does not depend on how many are validated.
+template<std::size_t N>
+struct SyntheticTable {
+    std::vector<std::string> storage;
+    std::array<std::string_view, N> views{};
+
+    SyntheticTable() {
+        storage.reserve(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            storage.push_back("glSyntheticEntryPoint" + std::to_string(i));
+            views[i] = storage.back();
+        }
+    }
+};
+
+void bench_name_lookup() {
+    std::printf("-- entry point name lookup --\n");
+
+    const std::array<std::string_view, 4> probes = { "glUseProgram", "glAttachShader", "glClear", "glViewport" };
+    char name[64];
+    std::snprintf(name, sizeof(name), "%zu validated entry points (compile time table)", gl_layer::entry_point_count);
+    bench(name, 10'000'000, [&](std::size_t i) {
+        sink += static_cast<std::size_t>(gl_layer::find_entry_point(probes[i & 3]));
+    });
+
+    static SyntheticTable<600> synthetic;
+    gl_layer::NameTable<600> table{ synthetic.views };
+    const std::array<std::string_view, 4> synthetic_probes = { synthetic.views[17], synthetic.views[599], "glClear", "glViewport" };
+    bench("600 validated entry points", 10'000'000, [&](std::size_t i) {
+        sink += table.find(synthetic_probes[i & 3]);
+    });
+}
+
+// Stand-ins for the driver function addresses a loader passes to gl_layer_callback.
+char fake_glUseProgram;
+char fake_glClear;
+char fake_glBindBuffer;
+char fake_glDrawArrays;
+char fake_glUniform4f;
+char fake_glGetShaderiv;
+
+void bench_callback() {
+    std::printf("-- gl_layer_callback --\n");
+
+    bench("validated call, name lookup (glUseProgram)", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glUseProgram", nullptr, 1, 0u);
+    });
+    bench("unvalidated call, name lookup (glClear)", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glClear", nullptr, 1, 0x4000u);
+    });
+    bench("validated call, cached func_ptr (glUseProgram)", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glUseProgram", &fake_glUseProgram, 1, 0u);
+    });
+    bench("unvalidated call, cached func_ptr (glClear)", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glClear", &fake_glClear, 1, 0x4000u);
+    });
+}
+
+// Compares the varargs callback against the typed hooks for the same validated calls. Program 1 is tracked and linked,
+// so glUseProgram goes through the full status validation on both paths.
+void bench_typed_hooks() {
+    std::printf("-- gl_layer_callback vs typed hooks --\n");
+
+    int status = 1;
+    gl_layer_on_glCompileShader(1);
+    gl_layer_on_glGetShaderiv(1, 0x8B81 /* GL_COMPILE_STATUS */, &status);
+    gl_layer_on_glAttachShader(1, 1);
+    gl_layer_on_glGetProgramiv(1, 0x8B82 /* GL_LINK_STATUS */, &status);
+
+    bench("gl_layer_callback(glUseProgram)", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glUseProgram", &fake_glUseProgram, 1, 1u);
+    });
+    bench("gl_layer_on_glUseProgram", 10'000'000, [](std::size_t) {
+        gl_layer_on_glUseProgram(1);
+    });
+    bench("gl_layer_callback(glGetShaderiv)", 10'000'000, [&status](std::size_t) {
+        gl_layer_callback("glGetShaderiv", &fake_glGetShaderiv, 3, 1u, 0x8B81u, &status);
+    });
+    bench("gl_layer_on_glGetShaderiv", 10'000'000, [&status](std::size_t) {
+        gl_layer_on_glGetShaderiv(1, 0x8B81, &status);
+    });
+}
+
+// A call whose rules are all disabled should cost about as much as a call to a function the layer does not validate.
+void bench_rule_mask() {
+    std::printf("-- rule mask --\n");
+
+    int status = 1;
+    bench("glUseProgram, all rules", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glUseProgram", &fake_glUseProgram, 1, 1u);
+    });
+    bench("glGetShaderiv, all rules", 10'000'000, [&status](std::size_t) {
+        gl_layer_callback("glGetShaderiv", &fake_glGetShaderiv, 3, 1u, 0x8B81u, &status);
+    });
+
+    gl_layer_set_rule_mask(GL_LAYER_RULE_SHADER_COMPILE);
+    bench("glUseProgram, program rules disabled", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glUseProgram", &fake_glUseProgram, 1, 1u);
+    });
+    gl_layer_set_rule_mask(GL_LAYER_RULE_NONE);
+    bench("glGetShaderiv, all rules disabled", 10'000'000, [&status](std::size_t) {
+        gl_layer_callback("glGetShaderiv", &fake_glGetShaderiv, 3, 1u, 0x8B81u, &status);
+    });
+    bench("glClear, not validated", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glClear", &fake_glClear, 1, 0x4000u);
+    });
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL);
+}
+
+// Cost per call of glUseProgram on a linked program when only one in N calls is validated.
+void bench_sampling() {
+    std::printf("-- sampling --\n");
+
+    for (unsigned int period : { 1u, 4u, 16u, 64u }) {
+        gl_layer_set_sampling(GL_LAYER_SAMPLE_CALLS, period);
+        char name[64];
+        std::snprintf(name, sizeof(name), "glUseProgram, 1 in %u calls validated", period);
+        bench(name, 10'000'000, [](std::size_t) {
+            gl_layer_callback("glUseProgram", &fake_glUseProgram, 1, 1u);
+        });
+    }
+    gl_layer_set_sampling(GL_LAYER_SAMPLE_ALL, 1);
+}
+
+// Rebinding the bound program skips the status checks while no program changed, binding a different one runs them.
+void bench_redundant_binds() {
+    std::printf("-- redundant binds --\n");
+
+    int status = 1;
+    gl_layer_on_glAttachShader(2, 1);
+    gl_layer_on_glGetProgramiv(2, 0x8B82 /* GL_LINK_STATUS */, &status);
+
+    bench("glUseProgram, program already bound", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glUseProgram", &fake_glUseProgram, 1, 1u);
+    });
+    bench("glUseProgram, alternating between two programs", 10'000'000, [](std::size_t i) {
+        gl_layer_callback("glUseProgram", &fake_glUseProgram, 1, 1u + (i & 1u));
+    });
+    gl_layer_end_frame();
+}
+
+// Cost of keeping the shadow state, for calls that change it and calls that are redundant.
+void bench_state_tracking() {
+    std::printf("-- state tracking --\n");
+
+    bench("glBindBuffer, new buffer every call", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glBindBuffer(0x8892 /* GL_ARRAY_BUFFER */, static_cast<unsigned int>(i & 7u) + 1u);
+    });
+    bench("glBindBuffer, redundant", 10'000'000, [](std::size_t) {
+        gl_layer_on_glBindBuffer(0x8892 /* GL_ARRAY_BUFFER */, 1u);
+    });
+    bench("glBindTexture, new texture every call", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glBindTexture(0x0DE1 /* GL_TEXTURE_2D */, static_cast<unsigned int>(i & 7u) + 1u);
+    });
+    bench("glEnable/glDisable, alternating", 10'000'000, [](std::size_t i) {
+        if (i & 1u) gl_layer_on_glEnable(0x0BE2 /* GL_BLEND */);
+        else gl_layer_on_glDisable(0x0BE2 /* GL_BLEND */);
+    });
+    bench("glBindBuffer through gl_layer_callback, redundant", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glBindBuffer", &fake_glBindBuffer, 2, 0x8892u, 1u);
+    });
+    gl_layer_end_frame();
+}
+
+// Draws with unchanged state only compare the state epoch, a draw after a state change is validated in full.
+void bench_draw_validation() {
+    std::printf("-- draw validation --\n");
+
+    gl_layer_on_glBindVertexArray(1);
+    gl_layer_on_glUseProgram(1);
+    bench("glDrawArrays, state unchanged", 10'000'000, [](std::size_t) {
+        gl_layer_on_glDrawArrays(0x0004 /* GL_TRIANGLES */, 0, 3);
+    });
+    bench("glUseProgram + glDrawArrays, program changes", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glUseProgram(1u + (i & 1u));
+        gl_layer_on_glDrawArrays(0x0004 /* GL_TRIANGLES */, 0, 3);
+    });
+    bench("glDrawArrays through gl_layer_callback, state unchanged", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glDrawArrays", &fake_glDrawArrays, 3, 0x0004u, 0, 3);
+    });
+    gl_layer_end_frame();
+}
+
+// glUniform is the most frequently called validated function. Every call looks up the bound program and the uniform at
+// its location, checks the type and count, and compares the values with the ones uploaded last.
+void bench_uniform_calls() {
+    std::printf("-- glUniform validation, 8 uniforms --\n");
+
+    int status = 1;
+    gl_layer_on_glAttachShader(uniform_program, 1);
+    gl_layer_on_glLinkProgram(uniform_program);
+    gl_layer_on_glGetProgramiv(uniform_program, 0x8B82 /* GL_LINK_STATUS */, &status);
+    gl_layer_on_glUseProgram(uniform_program);
+
+    const float values[4] = {};
+    bench("gl_layer_on_glUniform4f", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glUniform4f(static_cast<int>(i & 7), 1.0f, 2.0f, 3.0f, 4.0f);
+    });
+    bench("gl_layer_on_glUniform4fv", 10'000'000, [&values](std::size_t i) {
+        gl_layer_on_glUniform4fv(static_cast<int>(i & 7), 1, values);
+    });
+    bench("gl_layer_on_glProgramUniform4f", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glProgramUniform4f(uniform_program, static_cast<int>(i & 7), 1.0f, 2.0f, 3.0f, 4.0f);
+    });
+    bench("gl_layer_callback(glUniform4f)", 10'000'000, [](std::size_t i) {
+        gl_layer_callback("glUniform4f", &fake_glUniform4f, 5, static_cast<int>(i & 7), 1.0, 2.0, 3.0, 4.0);
+    });
+    bench("gl_layer_on_glUniform1i, wrong type (deduplicated)", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glUniform1i(static_cast<int>(i & 7), 0);
+    });
+
+    bench("gl_layer_on_glUniform4f, value changes", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glUniform4f(static_cast<int>(i & 7), static_cast<float>(i), 2.0f, 3.0f, 4.0f);
+    });
+
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL & ~GL_LAYER_RULE_UNIFORM);
+    bench("gl_layer_on_glUniform4f, uniform rule disabled", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glUniform4f(static_cast<int>(i & 7), 1.0f, 2.0f, 3.0f, 4.0f);
+    });
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL & ~GL_LAYER_RULE_REDUNDANT_UNIFORMS);
+    bench("gl_layer_on_glUniform4f, redundant uniforms rule disabled", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glUniform4f(static_cast<int>(i & 7), 1.0f, 2.0f, 3.0f, 4.0f);
+    });
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL);
+    gl_layer_on_glUseProgram(1);
+    gl_layer_end_frame();
+}
+
+// Recording a trace on top of validation, and on its own with every rule disabled. The last run records more calls than
+// the file holds, to show how many the ring keeps.
+void bench_trace_recording() {
+    std::printf("-- trace recording --\n");
+
+    const char* path = "gl_layer_bench_trace.bin";
+    if (gl_layer_start_trace(path, 1024 * 1024) != 0) {
+        std::printf("not available in this profile\n");
+        return;
+    }
+
+    gl_layer_on_glUseProgram(uniform_program);
+    const float values[4] = {};
+    bench("gl_layer_on_glUniform4f", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glUniform4f(static_cast<int>(i & 7), 1.0f, 2.0f, 3.0f, 4.0f);
+    });
+    bench("gl_layer_on_glUniform4fv", 10'000'000, [&values](std::size_t i) {
+        gl_layer_on_glUniform4fv(static_cast<int>(i & 7), 1, values);
+    });
+    bench("gl_layer_callback(glUniform4f)", 10'000'000, [](std::size_t i) {
+        gl_layer_callback("glUniform4f", &fake_glUniform4f, 5, static_cast<int>(i & 7), 1.0, 2.0, 3.0, 4.0);
+    });
+    bench("glDrawArrays through gl_layer_callback, state unchanged", 10'000'000, [](std::size_t) {
+        gl_layer_callback("glDrawArrays", &fake_glDrawArrays, 3, 0x0004u, 0, 3);
+    });
+
+    gl_layer_set_rule_mask(GL_LAYER_RULE_NONE);
+    bench("gl_layer_on_glUniform4f, recorded only", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glUniform4f(static_cast<int>(i & 7), 1.0f, 2.0f, 3.0f, 4.0f);
+    });
+    bench("gl_layer_on_glBindTexture, recorded only", 10'000'000, [](std::size_t i) {
+        gl_layer_on_glBindTexture(0x0DE1 /* GL_TEXTURE_2D */, static_cast<unsigned int>(i & 15));
+    });
+
+    gl_layer_start_trace(path, 1024 * 1024);
+    bench("gl_layer_on_glUniform4f, value changes, recorded only", 1'000'000, [](std::size_t i) {
+        gl_layer_on_glUniform4f(static_cast<int>(i & 7), static_cast<float>(i), 2.0f, 3.0f, 4.0f);
+    });
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL);
+
+    gl_layer::TraceReader reader;
+    std::size_t records = 0;
+    if (reader.open(path)) reader.for_each([&records](const gl_layer::TraceRecord&) { ++records; });
+    // glUniform is compiled out of the minimal profile, nothing was recorded then.
+    if (records > 0) {
+        std::printf("%-56s %8zu calls, %.2f bytes/call\n", "1 MiB trace keeps", records, 1024.0 * 1024.0 / static_cast<double>(records));
+    }
+
+    gl_layer_stop_trace();
+    std::remove(path);
+    gl_layer_on_glUseProgram(1);
+    gl_layer_end_frame();
+}
+
+// Validating a recorded trace offline: 10000 frames of 8 glUniform4f calls and a draw, replayed into a fresh context.
+void bench_trace_replay() {
+    std::printf("-- trace replay --\n");
+
+    // Large enough that no call is overwritten, so the trace has the link and reflection of the program.
+    const char* path = "gl_layer_bench_replay.bin";
+    if (!gl_layer::entry_point_compiled(gl_layer::EntryPoint::glUniform4f) || gl_layer_start_trace(path, 8 * 1024 * 1024) != 0) {
+        std::printf("not available in this profile\n");
+        return;
+    }
+
+    int status = 1;
+    gl_layer_on_glCompileShader(1);
+    gl_layer_on_glGetShaderiv(1, 0x8B81 /* GL_COMPILE_STATUS */, &status);
+    gl_layer_on_glAttachShader(uniform_program, 1);
+    gl_layer_on_glLinkProgram(uniform_program);
+    gl_layer_on_glGetProgramiv(uniform_program, 0x8B82 /* GL_LINK_STATUS */, &status);
+    gl_layer_on_glBindVertexArray(1);
+    gl_layer_on_glUseProgram(uniform_program);
+    for (unsigned int frame = 0; frame < 10'000; ++frame) {
+        for (int location = 0; location < 8; ++location) {
+            gl_layer_on_glUniform4f(location, static_cast<float>(frame), 2.0f, 3.0f, 4.0f);
+        }
+        gl_layer_on_glDrawArrays(0x0004 /* GL_TRIANGLES */, 0, 3);
+        gl_layer_end_frame();
+    }
+    gl_layer_stop_trace();
+    gl_layer_on_glUseProgram(1);
+    gl_layer_end_frame();
+
+    gl_layer::TraceReader reader;
+    if (reader.open(path)) {
+        gl_layer::TraceReplay replay(reader);
+        gl_layer::Context context(reader.gl_version(), &gl_layer::TraceReplay::gl_functions());
+        context.set_output_callback(&discard_output, nullptr);
+
+        auto start = std::chrono::steady_clock::now();
+        replay.run(context);
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        std::printf("%-56s %8.2f ns/call\n", "replay, every rule", ns / static_cast<double>(replay.stats().calls));
+    }
+    std::remove(path);
+}
+
+// Stand-in driver for the interposing loader. The driver functions do nothing, so the measurement is the layer's overhead.
+void driver_glUseProgram(unsigned int) {}
+void driver_glClear(unsigned int) {}
+
+void* stub_load_proc(const char* name) {
+    std::string_view function = name;
+    if (function == "glUseProgram") return reinterpret_cast<void*>(&driver_glUseProgram);
+    if (function == "glClear") return reinterpret_cast<void*>(&driver_glClear);
+    return nullptr;
+}
+
+void bench_interposing_loader() {
+    std::printf("-- gl_layer_load --\n");
+
+    GLLayerLoadProc load = gl_layer_load(&stub_load_proc);
+    auto use_program = reinterpret_cast<void (*)(unsigned int)>(load("glUseProgram"));
+    auto clear = reinterpret_cast<void (*)(unsigned int)>(load("glClear"));
+
+    // Call through volatile pointers so the empty driver functions are not inlined away.
+    void (*volatile raw_clear)(unsigned int) = &driver_glClear;
+    bench("unvalidated glClear, driver pointer", 10'000'000, [&](std::size_t) {
+        raw_clear(0x4000u);
+    });
+    void (*volatile loaded_clear)(unsigned int) = clear;
+    bench("unvalidated glClear, through gl_layer_load", 10'000'000, [&](std::size_t) {
+        loaded_clear(0x4000u);
+    });
+    void (*volatile loaded_use_program)(unsigned int) = use_program;
+    bench("validated glUseProgram, through gl_layer_load", 10'000'000, [&](std::size_t) {
+        loaded_use_program(1);
+    });
+}
+
+
+// Allocator that counts the bytes a container holds, used to compare memory per tracked object.
+std::size_t counted_bytes = 0;
+
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        counted_bytes += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) {
+        counted_bytes -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+void bench_object_tables() {
+    std::printf("-- object tables, 100k programs --\n");
+
+    constexpr gl_layer::GLuint object_count = 100'000;
+
+    // Look objects up in a random order, like an application using many programs would.
+    std::vector<gl_layer::GLuint> lookups(1 << 20);
+    std::mt19937 rng{ 42 };
+    std::uniform_int_distribution<gl_layer::GLuint> handle_dist{ 1, object_count };
+    for (auto& handle : lookups) handle = handle_dist(rng);
+
+    gl_layer::ObjectTable<gl_layer::Program> table;
+    for (gl_layer::GLuint handle = 1; handle <= object_count; ++handle) {
+        table.insert(handle, gl_layer::Program{ handle });
+    }
+
+    using CountedMap = std::unordered_map<gl_layer::GLuint, gl_layer::Program, std::hash<gl_layer::GLuint>, std::equal_to<gl_layer::GLuint>,
+                                          CountingAllocator<std::pair<const gl_layer::GLuint, gl_layer::Program>>>;
+    CountedMap map;
+    for (gl_layer::GLuint handle = 1; handle <= object_count; ++handle) {
+        map.emplace(handle, gl_layer::Program{ handle });
+    }
+
+    bench("ObjectTable lookup", 10'000'000, [&](std::size_t i) {
+        sink += table.find(lookups[i & (lookups.size() - 1)])->handle;
+    });
+    bench("unordered_map lookup", 10'000'000, [&](std::size_t i) {
+        sink += map.find(lookups[i & (lookups.size() - 1)])->second.handle;
+    });
+
+    std::printf("%-56s %8.1f bytes/object\n", "ObjectTable memory", static_cast<double>(table.memory_usage()) / object_count);
+    std::printf("%-56s %8.1f bytes/object\n", "unordered_map memory", static_cast<double>(counted_bytes) / object_count);
+}
+
+
+void bench_uniform_tables() {
+    std::printf("-- uniform tables, 32 uniforms --\n");
+
+    auto make_entries = [](gl_layer::GLint stride) {
+        std::vector<std::pair<gl_layer::GLint, gl_layer::UniformInfo>> entries;
+        for (gl_layer::GLint i = 0; i < 32; ++i) {
+            entries.emplace_back(i * stride, gl_layer::UniformInfo{ 1, 0x1406 /* GL_FLOAT */ });
+        }
+        return entries;
+    };
+
+    std::vector<gl_layer::GLint> lookups(1024);
+    std::mt19937 rng{ 42 };
+    std::uniform_int_distribution<gl_layer::GLint> index_dist{ 0, 31 };
+    for (auto& index : lookups) index = index_dist(rng);
+
+    for (gl_layer::GLint stride : { 1, 64 }) {
+        auto entries = make_entries(stride);
+        gl_layer::UniformTable table;
+        table.assign(entries);
+        std::unordered_map<gl_layer::GLint, gl_layer::UniformInfo> map(entries.begin(), entries.end());
+
+        std::string label = stride == 1 ? "contiguous locations" : "sparse locations";
+        bench(("UniformTable lookup, " + label).c_str(), 10'000'000, [&](std::size_t i) {
+            sink += static_cast<std::size_t>(table.find(lookups[i & 1023] * stride)->type);
+        });
+        bench(("unordered_map lookup, " + label).c_str(), 10'000'000, [&](std::size_t i) {
+            sink += static_cast<std::size_t>(map.find(lookups[i & 1023] * stride)->second.type);
+        });
+    }
+}
+
+
+// Draw validation looks for uniforms the bound program never wrote. The bitsets of all programs come from one pool per
+// share group, so tracking adds a few bytes per program instead of heap blocks of their own.
+void bench_uniform_writes() {
+    std::printf("-- uniform write bitsets --\n");
+
+    auto make_table = [](gl_layer::GLint uniform_count) {
+        std::vector<std::pair<gl_layer::GLint, gl_layer::UniformInfo>> entries;
+        for (gl_layer::GLint i = 0; i < uniform_count; ++i) {
+            entries.emplace_back(i, gl_layer::UniformInfo{ 1, 0x1406 /* GL_FLOAT */ });
+        }
+        gl_layer::UniformTable table;
+        table.assign(std::move(entries));
+        return table;
+    };
+
+    for (gl_layer::GLint uniform_count : { 32, 1024 }) {
+        auto pool = std::make_shared<gl_layer::BitsetPool>();
+        gl_layer::UniformTable table = make_table(uniform_count);
+        gl_layer::UniformWrites writes = gl_layer::UniformWrites::create(*pool, table);
+        writes.write(*pool, 0, uniform_count);
+
+        std::string label = "unset uniform test, " + std::to_string(uniform_count) + " uniforms set";
+        bench(label.c_str(), 10'000'000, [&](std::size_t) {
+            sink += static_cast<std::size_t>(writes.first_unset(*pool) + 1);
+        });
+    }
+
+    constexpr std::size_t program_count = 10'000;
+    auto pool = std::make_shared<gl_layer::BitsetPool>();
+    gl_layer::UniformTable table = make_table(32);
+    std::vector<gl_layer::UniformWrites> programs;
+    for (std::size_t i = 0; i < program_count; ++i) programs.push_back(gl_layer::UniformWrites::create(*pool, table));
+    double bytes = static_cast<double>(pool->memory_usage()) / program_count + sizeof(gl_layer::UniformWrites);
+    std::printf("%-56s %8.1f bytes/program\n", "memory, 32 uniforms, 10k programs", bytes);
+}
+
+void bench_message_output() {
+    std::printf("-- message output, deduplication off --\n");
+
+    gl_layer_set_message_dedup(0, 0);
+    // Program 2 was never created, every use reports an invalid handle.
+    auto start = std::chrono::steady_clock::now();
+    constexpr std::size_t message_count = 2'000'000;
+    for (std::size_t i = 0; i < message_count; ++i) {
+        gl_layer_on_glUseProgram(2);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-56s %8.2f M messages/s\n", "synchronous output", static_cast<double>(message_count) / seconds / 1e6);
+
+    gl_layer_set_async_output(1, 4096, GL_LAYER_BLOCK);
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < message_count; ++i) {
+        gl_layer_on_glUseProgram(2);
+    }
+    gl_layer_flush_output();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-56s %8.2f M messages/s\n", "asynchronous output", static_cast<double>(message_count) / seconds / 1e6);
+
+    gl_layer_set_async_output(0, 0, GL_LAYER_BLOCK);
+    gl_layer_set_message_dedup(1, 1000);
+}
+
+// Render threads validating glUseProgram on contexts of one share group, with and without a loader thread creating and
+// deleting other programs in the same group. Lookups take no lock, so throughput should grow with the thread count up to
+// the number of cores. Run last: once contexts share a group, every lookup pays for the epoch guard.
+void bench_share_group_scaling() {
+    std::printf("-- share group, glUseProgram from N threads --\n");
+
+    ContextGLFunctions functions;
+    functions.GetActiveUniform = &stub_get_active_uniform;
+    functions.GetUniformLocation = &stub_get_uniform_location;
+    functions.GetProgramiv = &stub_get_programiv;
+
+    constexpr std::size_t max_threads = 16;
+    constexpr std::size_t calls_per_thread = 2'000'000;
+    std::vector<GLLayerContext*> contexts;
+    for (std::size_t i = 0; i < max_threads + 1; ++i) {
+        contexts.push_back(gl_layer_create_context(3, 3, &functions, gl_layer_get_current_context()));
+    }
+
+    for (bool with_loader : { false, true }) {
+        for (std::size_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+            std::atomic<bool> done{ false };
+            std::thread loader;
+            if (with_loader) {
+                loader = std::thread([&] {
+                    gl_layer_make_current(contexts[max_threads]);
+                    int status = 1;
+                    for (unsigned int handle = 1000; !done.load(std::memory_order_relaxed); handle = handle < 100'000 ? handle + 1 : 1000) {
+                        gl_layer_on_glCompileShader(handle);
+                        gl_layer_on_glGetShaderiv(handle, 0x8B81 /* GL_COMPILE_STATUS */, &status);
+                        gl_layer_on_glAttachShader(handle, handle);
+                        gl_layer_on_glLinkProgram(handle);
+                        gl_layer_on_glGetProgramiv(handle, 0x8B82 /* GL_LINK_STATUS */, &status);
+                        gl_layer_on_glDeleteShader(handle);
+                        gl_layer_on_glDeleteProgram(handle);
+                    }
+                    gl_layer_make_current(nullptr);
+                });
+            }
+
+            std::vector<std::thread> threads;
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&contexts, t] {
+                    gl_layer_make_current(contexts[t]);
+                    for (std::size_t i = 0; i < calls_per_thread; ++i) {
+                        gl_layer_on_glUseProgram(1);
+                    }
+                    gl_layer_make_current(nullptr);
+                });
+            }
+            for (auto& thread : threads) thread.join();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            done.store(true);
+            if (loader.joinable()) loader.join();
+
+            char name[64];
+            std::snprintf(name, sizeof(name), "%2zu render thread(s)%s", thread_count, with_loader ? " + loader thread" : "");
+            double calls = static_cast<double>(thread_count * calls_per_thread);
+            std::printf("%-56s %8.2f M calls/s\n", name, calls / seconds / 1e6);
+        }
+    }
+
+    for (GLLayerContext* context : contexts) gl_layer_destroy_context(context);
+}
+
+}
+
+int main() {
+    ContextGLFunctions functions;
+    functions.GetActiveUniform = &stub_get_active_uniform;
+    functions.GetUniformLocation = &stub_get_uniform_location;
+    functions.GetProgramiv = &stub_get_programiv;
+    if (gl_layer_init(3, 3, &functions)) {
+        std::fprintf(stderr, "Could not initialize OpenGL Validation Layer\n");
+        return 1;
+    }
+    gl_layer_set_output_callback(&discard_output, nullptr);
+
+    // Run the benchmarks once per GL_VALIDATION_LAYER_PROFILE to measure what each profile costs.
+    constexpr const char* profile_names[] = { "off", "minimal", "full" };
+    std::printf("validation profile: %s\n", profile_names[GL_LAYER_PROFILE]);
+
+    bench_name_lookup();
+    bench_callback();
+    bench_typed_hooks();
+    bench_rule_mask();
+    bench_sampling();
+    bench_redundant_binds();
+    bench_state_tracking();
+    bench_draw_validation();
+    bench_uniform_calls();
+    bench_trace_recording();
+    bench_trace_replay();
+    bench_interposing_loader();
+    bench_object_tables();
+    bench_uniform_tables();
+    bench_uniform_writes();
+    bench_message_output();
+    bench_share_group_scaling();
+
+    gl_layer_terminate();
+    return 0;
+}
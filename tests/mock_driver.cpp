@@ -0,0 +1,1127 @@
+// Headless tests that drive the validation layer with a mock driver instead of an OpenGL context. The mock records
+// every query the layer issues, so tests can check when and how often the layer talks to the driver.
+
+#include <gl_layer/context.h>
+#include <gl_layer/private/messages.h>
+#include <gl_layer/private/replay.h>
+#include <gl_layer/private/trace.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <new>
+#include <vector>
+
+// Counts heap allocations made anywhere in the process, to check the layer does not allocate on hot paths.
+static std::atomic<std::size_t> allocation_count{ 0 };
+
+void* operator new(std::size_t size) {
+    ++allocation_count;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                          \
+        }                                                                        \
+    } while (0)
+
+constexpr unsigned int GL_COMPILE_STATUS = 0x8B81;
+constexpr unsigned int GL_LINK_STATUS = 0x8B82;
+constexpr unsigned int GL_ACTIVE_UNIFORMS = 0x8B86;
+constexpr unsigned int GL_ACTIVE_UNIFORM_MAX_LENGTH = 0x8B87;
+constexpr unsigned int GL_FLOAT = 0x1406;
+constexpr unsigned int GL_FLOAT_VEC3 = 0x8B51;
+constexpr unsigned int GL_SAMPLER_2D = 0x8B5E;
+constexpr unsigned int GL_COMPLETION_STATUS_KHR = 0x91B1;
+constexpr unsigned int GL_TRIANGLES = 0x0004;
+constexpr unsigned int GL_UNSIGNED_INT = 0x1405;
+constexpr unsigned int GL_TEXTURE_2D = 0x0DE1;
+
+// A program with two active uniforms, u0 at location 0 and u1 at location 1. Tests can enable three more: an array of 4
+// floats u2 at locations 2 to 5, a sampler u6 at location 6 and u7 at location 7.
+struct MockUniform {
+    int size;
+    unsigned int type;
+    const char* name;
+};
+
+constexpr MockUniform mock_uniforms[] = {
+    { 1, GL_FLOAT_VEC3, "u0" },
+    { 1, GL_FLOAT_VEC3, "u1" },
+    { 4, GL_FLOAT, "u2[0]" },
+    { 1, GL_SAMPLER_2D, "u6" },
+    { 1, GL_FLOAT_VEC3, "u7" },
+};
+
+struct MockDriver {
+    std::atomic<int> queries{ 0 };
+    int uniform_count = 2;
+
+    void reset() {
+        queries = 0;
+        uniform_count = 2;
+    }
+} driver;
+
+void mock_get_active_uniform(unsigned, unsigned index, int, int* length, int* size, unsigned* type, char* name) {
+    ++driver.queries;
+    std::snprintf(name, 8, "%s", mock_uniforms[index].name);
+    *length = static_cast<int>(std::strlen(name));
+    *size = mock_uniforms[index].size;
+    *type = mock_uniforms[index].type;
+}
+
+int mock_get_uniform_location(unsigned, const char* name) {
+    ++driver.queries;
+    return std::atoi(name + 1);
+}
+
+void mock_get_programiv(unsigned, unsigned pname, int* params) {
+    ++driver.queries;
+    if (pname == GL_ACTIVE_UNIFORMS) *params = driver.uniform_count;
+    else if (pname == GL_ACTIVE_UNIFORM_MAX_LENGTH) *params = 8;
+    else *params = 0;
+}
+
+std::vector<std::string> messages;
+
+void record_output(const char* text, void*) {
+    messages.emplace_back(text);
+}
+
+void init_layer() {
+    ContextGLFunctions functions;
+    functions.GetActiveUniform = &mock_get_active_uniform;
+    functions.GetUniformLocation = &mock_get_uniform_location;
+    functions.GetProgramiv = &mock_get_programiv;
+    gl_layer_init(3, 3, &functions);
+    gl_layer_set_output_callback(&record_output, nullptr);
+    driver.reset();
+    messages.clear();
+}
+
+// Creates program 1 from shader 1, with all statuses checked like a well behaved application would.
+void create_program(bool check_link_status = true) {
+    int status = 1;
+    gl_layer_callback("glCompileShader", nullptr, 1, 1u);
+    gl_layer_callback("glGetShaderiv", nullptr, 3, 1u, GL_COMPILE_STATUS, &status);
+    gl_layer_callback("glAttachShader", nullptr, 2, 1u, 1u);
+    gl_layer_callback("glLinkProgram", nullptr, 1, 1u);
+    if (check_link_status) {
+        gl_layer_callback("glGetProgramiv", nullptr, 3, 1u, GL_LINK_STATUS, &status);
+    }
+}
+
+void test_link_issues_no_queries() {
+    init_layer();
+    create_program();
+    CHECK(driver.queries == 0);
+    CHECK(messages.empty());
+    gl_layer_terminate();
+}
+
+void test_reflection_on_first_use() {
+    init_layer();
+    create_program();
+
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    // GL_ACTIVE_UNIFORMS, GL_ACTIVE_UNIFORM_MAX_LENGTH, then one GetActiveUniform and GetUniformLocation per uniform.
+    CHECK(driver.queries == 6);
+
+    driver.reset();
+    gl_layer_callback("glUseProgram", nullptr, 1, 0u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(driver.queries == 0);
+
+    // A relink invalidates the reflected uniforms, they are queried again on the next use.
+    int status = 1;
+    gl_layer_callback("glLinkProgram", nullptr, 1, 1u);
+    gl_layer_callback("glGetProgramiv", nullptr, 3, 1u, GL_LINK_STATUS, &status);
+    CHECK(driver.queries == 0);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(driver.queries == 6);
+    CHECK(messages.empty());
+
+    // Using the program finishes its link, so a relink whose status is not queried is reflected on the next use too.
+    driver.reset();
+    gl_layer_callback("glLinkProgram", nullptr, 1, 1u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(driver.queries == 6);
+    GLLayerCompileStats stats{};
+    CHECK(gl_layer_get_compile_stats(&stats) == 0);
+    CHECK(stats.in_flight == 0);
+    gl_layer_on_glUniform1i(0, 1);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() &&
+          messages[0] == "glUniform1i(location = 0, v0 = 1): Function does not match the type of the uniform at this location.");
+    gl_layer_terminate();
+}
+
+void test_no_reflection_for_unchecked_program() {
+    init_layer();
+    create_program(false);
+
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(driver.queries == 0);
+    CHECK(messages.size() == 1);
+    gl_layer_terminate();
+}
+
+
+void test_parallel_compile() {
+    init_layer();
+
+    int done = 0;
+    int ok = 1;
+    for (unsigned int shader = 1; shader <= 3; ++shader) {
+        gl_layer_callback("glCompileShader", nullptr, 1, shader);
+    }
+    // The application polls until every compile is done, then checks the results.
+    for (unsigned int shader = 1; shader <= 3; ++shader) {
+        gl_layer_callback("glGetShaderiv", nullptr, 3, shader, GL_COMPLETION_STATUS_KHR, &done);
+    }
+    done = 1;
+    for (unsigned int shader = 1; shader <= 3; ++shader) {
+        gl_layer_callback("glGetShaderiv", nullptr, 3, shader, GL_COMPLETION_STATUS_KHR, &done);
+        gl_layer_callback("glGetShaderiv", nullptr, 3, shader, GL_COMPILE_STATUS, &ok);
+        gl_layer_callback("glAttachShader", nullptr, 2, shader, shader);
+        gl_layer_callback("glLinkProgram", nullptr, 1, shader);
+    }
+
+    GLLayerCompileStats stats{};
+    CHECK(gl_layer_get_compile_stats(&stats) == 0);
+    CHECK(stats.compiles == 3);
+    CHECK(stats.links == 3);
+    CHECK(stats.completion_polls == 6);
+    CHECK(stats.max_in_flight == 3);
+    CHECK(stats.in_flight == 3);
+
+    // Using a program whose link is still in flight is reported, and must not make the layer query (and block on) it.
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(messages.size() == 1);
+    CHECK(driver.queries == 0);
+
+    // Completion polling alone does not count as checking the link status.
+    gl_layer_callback("glGetProgramiv", nullptr, 3, 2u, GL_COMPLETION_STATUS_KHR, &done);
+    gl_layer_callback("glUseProgram", nullptr, 1, 2u);
+    CHECK(messages.size() == 2);
+    CHECK(driver.queries == 0);
+
+    gl_layer_callback("glGetProgramiv", nullptr, 3, 3u, GL_LINK_STATUS, &ok);
+    gl_layer_callback("glUseProgram", nullptr, 1, 3u);
+    CHECK(messages.size() == 2);
+    CHECK(driver.queries == 6);
+
+    CHECK(gl_layer_get_compile_stats(&stats) == 0);
+    CHECK(stats.in_flight == 1);
+    gl_layer_terminate();
+}
+
+
+std::atomic<bool> writer_entered{ false };
+std::atomic<bool> writer_released{ false };
+
+void blocking_output(const char* text, void* user_data) {
+    writer_entered = true;
+    while (!writer_released) std::this_thread::yield();
+    record_output(text, user_data);
+}
+
+void test_async_output() {
+    init_layer();
+
+    // Invalid program handles, each use reports one message.
+    CHECK(gl_layer_set_message_dedup(0, 0) == 0);
+    CHECK(gl_layer_set_async_output(1, 64, GL_LAYER_BLOCK) == 0);
+    for (unsigned int i = 0; i < 1000; ++i) {
+        gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    }
+    gl_layer_flush_output();
+    CHECK(messages.size() == 1000);
+    CHECK(gl_layer_get_dropped_message_count() == 0);
+
+    // Stall the writer on the first message, then overflow the queue.
+    messages.clear();
+    gl_layer_set_output_callback(&blocking_output, nullptr);
+    CHECK(gl_layer_set_async_output(1, 8, GL_LAYER_DROP_NEWEST) == 0);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    while (!writer_entered) std::this_thread::yield();
+    for (unsigned int i = 0; i < 19; ++i) {
+        gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    }
+    writer_released = true;
+    gl_layer_flush_output();
+    CHECK(messages.size() == 9);
+    CHECK(gl_layer_get_dropped_message_count() == 11);
+
+    // Turning async output off delivers synchronously again.
+    CHECK(gl_layer_set_async_output(0, 0, GL_LAYER_DROP_NEWEST) == 0);
+    gl_layer_set_output_callback(&record_output, nullptr);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(messages.size() == 10);
+    CHECK(gl_layer_get_dropped_message_count() == 11);
+    gl_layer_terminate();
+}
+
+
+void test_message_dedup() {
+    init_layer();
+    create_program(false);
+    CHECK(gl_layer_set_message_dedup(1, 60'000) == 0);
+
+    for (int i = 0; i < 1000; ++i) {
+        gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+        gl_layer_callback("glUseProgram", nullptr, 1, 2u);
+    }
+    CHECK(messages.size() == 2);
+
+    // The summary of suppressed repeats is written on shutdown at the latest.
+    gl_layer_terminate();
+    CHECK(messages.size() == 4);
+    auto reported = [](const char* text) { return std::find(messages.begin(), messages.end(), text) != messages.end(); };
+    CHECK(reported("Suppressed 999 repeat(s) of ProgramLinkStatusUnchecked for object 1."));
+    CHECK(reported("Suppressed 999 repeat(s) of InvalidProgramHandle for object 2."));
+
+    // Once the interval passed, the end of the frame writes the summary, even if the repeats stopped.
+    init_layer();
+    create_program(false);
+    CHECK(gl_layer_set_message_dedup(1, 0) == 0);
+    for (int i = 0; i < 3; ++i) gl_layer_on_glUseProgram(1);
+    CHECK(messages.size() == 1);
+    gl_layer_end_frame();
+    CHECK(messages.size() == 2);
+    CHECK(reported("Suppressed 2 repeat(s) of ProgramLinkStatusUnchecked for object 1."));
+
+    // Deleting the program writes its summary and forgets its messages, a new program with the handle is reported again.
+    CHECK(gl_layer_set_message_dedup(1, 60'000) == 0);
+    messages.clear();
+    gl_layer_on_glUseProgram(1);
+    gl_layer_on_glUseProgram(1);
+    gl_layer_on_glDeleteProgram(1);
+    CHECK(messages.size() == 2);
+    CHECK(reported("Suppressed 1 repeat(s) of ProgramLinkStatusUnchecked for object 1."));
+    gl_layer_on_glAttachShader(1, 1);
+    gl_layer_on_glLinkProgram(1);
+    gl_layer_on_glUseProgram(1);
+    CHECK(messages.size() == 3);
+
+    // With asynchronous output the background thread writes the summary, without another call into the layer.
+    messages.clear();
+    CHECK(gl_layer_set_message_dedup(1, 10) == 0);
+    CHECK(gl_layer_set_async_output(1, 64, GL_LAYER_BLOCK) == 0);
+    for (int i = 0; i < 3; ++i) gl_layer_on_glUseProgram(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CHECK(gl_layer_set_async_output(0, 0, GL_LAYER_BLOCK) == 0);
+    CHECK(messages.size() == 2);
+    CHECK(reported("Suppressed 2 repeat(s) of ProgramLinkStatusUnchecked for object 1."));
+    gl_layer_terminate();
+
+    // Destroying a context stops its background writer before the repeats it summarizes are gone.
+    init_layer();
+    create_program(false);
+    CHECK(gl_layer_set_message_dedup(1, 1) == 0);
+    CHECK(gl_layer_set_async_output(1, 64, GL_LAYER_BLOCK) == 0);
+    for (int i = 0; i < 3; ++i) gl_layer_on_glUseProgram(1);
+    gl_layer_terminate();
+    CHECK(messages.size() == 2);
+
+    // Pairs that stopped repeating are forgotten before the set grows past its limit.
+    gl_layer::MessageDeduplicator dedup;
+    for (unsigned int i = 0; i < 4 * gl_layer::MessageDeduplicator::max_entries; ++i) {
+        dedup.first_occurrence(gl_layer::MessageId::InvalidProgramHandle, i);
+    }
+    CHECK(dedup.size() <= gl_layer::MessageDeduplicator::max_entries);
+}
+
+
+std::size_t counted_messages = 0;
+
+void count_output(const char*, void*) {
+    ++counted_messages;
+}
+
+void test_output_does_not_allocate() {
+    init_layer();
+    CHECK(gl_layer_set_message_dedup(0, 0) == 0);
+    gl_layer_set_output_callback(&count_output, nullptr);
+
+    // The first messages may set up per-thread buffers.
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    gl_layer_callback("glAttachShader", nullptr, 2, 1u, 1u);
+
+    std::size_t allocations = allocation_count;
+    for (int i = 0; i < 1000; ++i) {
+        gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+        gl_layer_callback("glAttachShader", nullptr, 2, 1u, 1u);
+    }
+    CHECK(allocation_count == allocations);
+    CHECK(counted_messages == 2002);
+    gl_layer_terminate();
+}
+
+
+std::vector<GLLayerMessage> records;
+
+void record_message(const GLLayerMessage* message, void*) {
+    records.push_back(*message);
+}
+
+void test_structured_messages() {
+    init_layer();
+    records.clear();
+    gl_layer_set_message_callback(&record_message, nullptr);
+    create_program(false);
+
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    int status = 0;
+    gl_layer_callback("glGetShaderiv", nullptr, 3, 7u, GL_COMPILE_STATUS, &status);
+
+    // No text is built while a message callback is set.
+    CHECK(messages.empty());
+    CHECK(records.size() == 2);
+    if (records.size() == 2) {
+        const GLLayerMessage& use = records[0];
+        CHECK(std::string(gl_layer_message_id_name(use.id)) == "ProgramLinkStatusUnchecked");
+        CHECK(std::string(gl_layer_entry_point_name(use.entry_point)) == "glUseProgram");
+        CHECK(use.severity == GL_LAYER_SEVERITY_WARNING);
+        CHECK(use.handle_count == 1 && use.handles[0] == 1);
+        CHECK(use.arg_count == 1 && use.args[0] == 1);
+
+        char text[256];
+        std::size_t length = gl_layer_format_message(&use, text, sizeof(text));
+        CHECK(std::string(text) == "glUseProgram(program = 1): Always check program link status before trying to use the object.");
+        CHECK(length == std::strlen(text));
+
+        // Truncated output still reports the full length.
+        char small[8];
+        CHECK(gl_layer_format_message(&use, small, sizeof(small)) == length);
+        CHECK(std::string(small) == "glUsePr");
+
+        const GLLayerMessage& query = records[1];
+        CHECK(query.severity == GL_LAYER_SEVERITY_ERROR);
+        CHECK(query.arg_count == 3 && query.args[1] == GL_COMPILE_STATUS);
+        gl_layer_format_message(&query, text, sizeof(text));
+        CHECK(std::string(text).rfind("glGetShaderiv(shader = 7, pname = GL_COMPILE_STATUS, params = ", 0) == 0);
+    }
+
+    gl_layer_set_message_callback(nullptr, nullptr);
+    gl_layer_callback("glUseProgram", nullptr, 1, 3u);
+    CHECK(messages.size() == 1);
+    CHECK(records.size() == 2);
+    gl_layer_terminate();
+}
+
+void test_rule_mask() {
+    init_layer();
+    CHECK(gl_layer_get_rule_mask() == GL_LAYER_RULE_ALL);
+
+    // Only the program rules: shaders are not tracked, so attaching an unknown shader is fine.
+    gl_layer_set_rule_mask(GL_LAYER_RULE_PROGRAM_LINK | GL_LAYER_RULE_PROGRAM_BOUND);
+    gl_layer_callback("glCompileShader", nullptr, 1, 1u);
+    gl_layer_callback("glCompileShader", nullptr, 1, 1u);
+    gl_layer_callback("glAttachShader", nullptr, 2, 1u, 9u);
+    gl_layer_callback("glLinkProgram", nullptr, 1, 1u);
+    CHECK(messages.empty());
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(messages.size() == 1);
+
+    // Disabled rules skip the whole call, the program above is not checked or tracked any further.
+    messages.clear();
+    gl_layer_set_rule_mask(GL_LAYER_RULE_SHADER_COMPILE);
+    CHECK(gl_layer_get_rule_mask() == GL_LAYER_RULE_SHADER_COMPILE);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    gl_layer_callback("glLinkProgram", nullptr, 1, 5u);
+    gl_layer_on_glDeleteProgram(5);
+    CHECK(messages.empty());
+    gl_layer_callback("glDeleteShader", nullptr, 1, 4u);
+    CHECK(messages.size() == 1);
+
+    messages.clear();
+    gl_layer_set_rule_mask(GL_LAYER_RULE_NONE);
+    gl_layer_callback("glDeleteShader", nullptr, 1, 4u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 7u);
+    CHECK(messages.empty());
+    gl_layer_terminate();
+}
+
+void test_multiple_contexts() {
+    init_layer();
+    GLLayerContext* main_context = gl_layer_get_current_context();
+    CHECK(main_context != nullptr);
+
+    ContextGLFunctions functions;
+    functions.GetActiveUniform = &mock_get_active_uniform;
+    functions.GetUniformLocation = &mock_get_uniform_location;
+    functions.GetProgramiv = &mock_get_programiv;
+
+    // Objects created on a shared context are known to the main context.
+    GLLayerContext* upload_context = gl_layer_create_context(3, 3, &functions, main_context);
+    std::thread worker([upload_context] {
+        gl_layer_make_current(upload_context);
+        CHECK(gl_layer_get_current_context() == upload_context);
+        create_program();
+        gl_layer_make_current(nullptr);
+    });
+    worker.join();
+    CHECK(gl_layer_get_current_context() == main_context);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(messages.empty());
+
+    // A context that does not share objects does not know the program, and reports through the inherited output.
+    GLLayerContext* other_context = gl_layer_create_context(3, 3, &functions, nullptr);
+    gl_layer_make_current(other_context);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(messages.size() == 1);
+    gl_layer_make_current(nullptr);
+
+    gl_layer_destroy_context(other_context);
+    gl_layer_destroy_context(upload_context);
+    gl_layer_terminate();
+
+    // A thread whose current context was destroyed on another thread goes back to the default context.
+    init_layer();
+    GLLayerContext* first_context = gl_layer_get_current_context();
+    std::atomic<int> stage{ 0 };
+    std::thread render([first_context, &stage] {
+        gl_layer_make_current(first_context);
+        stage = 1;
+        while (stage != 2) std::this_thread::yield();
+        gl_layer_on_glUseProgram(5);
+    });
+    while (stage != 1) std::this_thread::yield();
+    gl_layer_terminate();
+    init_layer();
+    stage = 2;
+    render.join();
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glUseProgram(program = 5): Invalid program handle.");
+    gl_layer_terminate();
+}
+
+// Loader threads create and delete programs in a shared group while render threads keep using other programs of the
+// same group. Nothing may be reported for the programs in use, and every deleted object must be gone afterwards.
+void test_concurrent_share_group() {
+    init_layer();
+    static std::atomic<int> reported{ 0 };
+    gl_layer_set_message_callback([](const GLLayerMessage*, void*) { ++reported; }, nullptr);
+
+    // Programs 1..8 are created up front and only used from now on.
+    int status = 1;
+    for (unsigned int handle = 1; handle <= 8; ++handle) {
+        gl_layer_on_glCompileShader(handle);
+        gl_layer_on_glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
+        gl_layer_on_glAttachShader(handle, handle);
+        gl_layer_on_glLinkProgram(handle);
+        gl_layer_on_glGetProgramiv(handle, GL_LINK_STATUS, &status);
+    }
+
+    ContextGLFunctions functions;
+    functions.GetActiveUniform = &mock_get_active_uniform;
+    functions.GetUniformLocation = &mock_get_uniform_location;
+    functions.GetProgramiv = &mock_get_programiv;
+
+    constexpr int loader_count = 4;
+    constexpr int render_count = 4;
+    constexpr unsigned int objects_per_loader = 2000;
+    std::vector<GLLayerContext*> contexts;
+    for (int i = 0; i < loader_count + render_count; ++i) {
+        contexts.push_back(gl_layer_create_context(3, 3, &functions, gl_layer_get_current_context()));
+    }
+
+    std::atomic<int> loaders_running{ loader_count };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < loader_count; ++i) {
+        threads.emplace_back([&, i] {
+            gl_layer_make_current(contexts[static_cast<std::size_t>(i)]);
+            int ok = 1;
+            // Every loader has its own handle range, interleaved so they share pages and shards.
+            for (unsigned int n = 0; n < objects_per_loader; ++n) {
+                unsigned int handle = 100 + n * loader_count + static_cast<unsigned int>(i);
+                gl_layer_on_glCompileShader(handle);
+                gl_layer_on_glGetShaderiv(handle, GL_COMPILE_STATUS, &ok);
+                gl_layer_on_glAttachShader(handle, handle);
+                gl_layer_on_glLinkProgram(handle);
+                gl_layer_on_glGetProgramiv(handle, GL_LINK_STATUS, &ok);
+                gl_layer_on_glUseProgram(handle);
+                gl_layer_on_glDeleteShader(handle);
+                gl_layer_on_glDeleteProgram(handle);
+            }
+            gl_layer_make_current(nullptr);
+            --loaders_running;
+        });
+    }
+    for (int i = 0; i < render_count; ++i) {
+        threads.emplace_back([&, i] {
+            gl_layer_make_current(contexts[static_cast<std::size_t>(loader_count + i)]);
+            unsigned int handle = 1;
+            while (loaders_running.load() > 0) {
+                gl_layer_on_glUseProgram(handle);
+                handle = handle % 8 + 1;
+            }
+            gl_layer_make_current(nullptr);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    CHECK(reported.load() == 0);
+    gl_layer_on_glUseProgram(100);
+    gl_layer_on_glDeleteShader(100 + objects_per_loader * loader_count - 1);
+    CHECK(reported.load() == 2);
+
+    GLLayerCompileStats stats{};
+    gl_layer_get_compile_stats(&stats);
+    CHECK(stats.compiles == 8 + loader_count * objects_per_loader);
+    CHECK(stats.in_flight == 0);
+
+    for (GLLayerContext* context : contexts) gl_layer_destroy_context(context);
+    gl_layer_terminate();
+}
+
+void test_sampling() {
+    init_layer();
+    gl_layer_set_message_dedup(0, 0);
+    // Unsampled binds of the invalid program still count as binding it, and make the next bind redundant.
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL & ~GL_LAYER_RULE_REDUNDANT_STATE);
+
+    // Every fourth call is validated, starting with the first. Program 9 does not exist.
+    gl_layer_set_sampling(GL_LAYER_SAMPLE_CALLS, 4);
+    for (int i = 0; i < 8; ++i) gl_layer_callback("glUseProgram", nullptr, 1, 9u);
+    CHECK(messages.size() == 2);
+
+    // Unsampled calls still track objects, so the sampled use of the program they created is fine. The first call to
+    // each function is sampled, make those on another object.
+    messages.clear();
+    gl_layer_set_sampling(GL_LAYER_SAMPLE_CALLS, 1000);
+    int status = 1;
+    gl_layer_callback("glCompileShader", nullptr, 1, 50u);
+    gl_layer_callback("glGetShaderiv", nullptr, 3, 50u, GL_COMPILE_STATUS, &status);
+    gl_layer_callback("glAttachShader", nullptr, 2, 50u, 50u);
+    gl_layer_callback("glLinkProgram", nullptr, 1, 50u);
+    gl_layer_callback("glGetProgramiv", nullptr, 3, 50u, GL_LINK_STATUS, &status);
+    create_program();
+    gl_layer_set_sampling(GL_LAYER_SAMPLE_CALLS, 1000);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(messages.empty());
+    CHECK(driver.queries == 6);
+
+    // Every second frame is validated, starting with the current one.
+    gl_layer_set_sampling(GL_LAYER_SAMPLE_FRAMES, 2);
+    for (int frame = 0; frame < 4; ++frame) {
+        gl_layer_callback("glUseProgram", nullptr, 1, 9u);
+        gl_layer_callback("glUseProgram", nullptr, 1, 9u);
+        gl_layer_end_frame();
+    }
+    CHECK(messages.size() == 4);
+    gl_layer_terminate();
+}
+
+
+void test_redundant_program_binds() {
+    init_layer();
+    gl_layer_set_message_dedup(0, 0);
+    create_program();
+
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 0u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    // Redundant binds are only reported once the frame ends, one summary per program.
+    CHECK(messages.empty());
+    gl_layer_end_frame();
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glUseProgram: Program 1 was bound 3 time(s) this frame while already bound.");
+
+    GLLayerFrameStats stats{};
+    CHECK(gl_layer_get_frame_stats(&stats) == 0);
+    CHECK(stats.frame == 0);
+    CHECK(stats.redundant_program_binds == 3);
+
+    // Rebinding skips the checks only while no program changed, deleting the bound program is still found.
+    messages.clear();
+    gl_layer_callback("glDeleteProgram", nullptr, 1, 1u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 1u);
+    CHECK(messages.size() == 1);
+    gl_layer_end_frame();
+
+    // Without the rule, binds are not counted.
+    messages.clear();
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL & ~GL_LAYER_RULE_REDUNDANT_STATE);
+    gl_layer_callback("glUseProgram", nullptr, 1, 0u);
+    gl_layer_callback("glUseProgram", nullptr, 1, 0u);
+    gl_layer_end_frame();
+    gl_layer_get_frame_stats(&stats);
+    CHECK(stats.frame == 2);
+    CHECK(stats.redundant_program_binds == 0);
+    CHECK(messages.empty());
+    gl_layer_terminate();
+}
+
+void test_redundant_state_changes() {
+    init_layer();
+    constexpr unsigned int GL_BLEND = 0x0BE2;
+    constexpr unsigned int GL_TEXTURE_2D = 0x0DE1;
+    constexpr unsigned int GL_TEXTURE0 = 0x84C0;
+    constexpr unsigned int GL_ARRAY_BUFFER = 0x8892;
+    constexpr unsigned int GL_ELEMENT_ARRAY_BUFFER = 0x8893;
+
+    // The first call never counts, the state it replaces is unknown.
+    gl_layer_on_glBindBuffer(GL_ARRAY_BUFFER, 1);
+    gl_layer_on_glBindBuffer(GL_ARRAY_BUFFER, 1);
+    gl_layer_on_glEnable(GL_BLEND);
+    gl_layer_on_glEnable(GL_BLEND);
+    gl_layer_on_glDisable(GL_BLEND);
+
+    // Textures are tracked per unit, texture unit 0 is active until glActiveTexture is called, like in a new context.
+    gl_layer_on_glBindTexture(GL_TEXTURE_2D, 5);
+    gl_layer_on_glBindTexture(GL_TEXTURE_2D, 5);
+    gl_layer_on_glActiveTexture(GL_TEXTURE0 + 1);
+    gl_layer_on_glBindTexture(GL_TEXTURE_2D, 5);
+
+    // The element array buffer belongs to the vertex array, deleting a buffer unbinds it.
+    gl_layer_on_glBindVertexArray(1);
+    gl_layer_on_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 2);
+    gl_layer_on_glBindVertexArray(2);
+    gl_layer_on_glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 2);
+    unsigned int deleted = 1;
+    gl_layer_on_glDeleteBuffers(1, &deleted);
+    gl_layer_on_glBindBuffer(GL_ARRAY_BUFFER, 1);
+
+    CHECK(messages.empty());
+    gl_layer_end_frame();
+    CHECK(messages.size() == 3);
+    CHECK(std::find(messages.begin(), messages.end(),
+                    "glBindBuffer: 1 of 5 call(s) this frame set state to the value it already had.") != messages.end());
+
+    GLLayerFrameStats stats{};
+    gl_layer_get_frame_stats(&stats);
+    CHECK(stats.state_changes == 14);
+    CHECK(stats.redundant_state_changes == 3);
+    CHECK(stats.redundant_program_binds == 0);
+
+    // A frame without redundant calls reports nothing.
+    messages.clear();
+    gl_layer_on_glDepthFunc(0x0201 /* GL_LESS */);
+    gl_layer_on_glBlendFunc(0x0302 /* GL_SRC_ALPHA */, 0x0303 /* GL_ONE_MINUS_SRC_ALPHA */);
+    gl_layer_end_frame();
+    CHECK(messages.empty());
+    gl_layer_get_frame_stats(&stats);
+    CHECK(stats.frame == 1);
+    CHECK(stats.state_changes == 2);
+
+    // The active texture unit is kept while the rule that follows it stays enabled.
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL & ~GL_LAYER_RULE_DRAW_STATE);
+    gl_layer_on_glActiveTexture(GL_TEXTURE0 + 1);
+    gl_layer_end_frame();
+    gl_layer_get_frame_stats(&stats);
+    CHECK(stats.redundant_state_changes == 1);
+    gl_layer_terminate();
+}
+
+void test_draw_validation() {
+    init_layer();
+    gl_layer_set_message_dedup(0, 0);
+    create_program();
+    const float value[3] = {};
+
+    // A new context has no vertex array bound, so a draw without ever binding one is reported. Changing the rule mask
+    // does not forget that.
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.size() == 2);
+    if (messages.size() == 2) {
+        CHECK(messages[0] == "glDrawArrays: No program bound.");
+        CHECK(messages[1] == "glDrawArrays: No vertex array object bound, this is an error in core profile contexts.");
+    }
+    messages.clear();
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL & ~GL_LAYER_RULE_PROGRAM_BOUND);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glDrawArrays: No vertex array object bound, this is an error in core profile contexts.");
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL);
+
+    // Uniforms have to be written before drawing, the program's uniforms are found on first use.
+    messages.clear();
+    gl_layer_on_glBindVertexArray(1);
+    gl_layer_on_glUseProgram(1);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glDrawArrays: Uniform at location 0 of program 1 was not set since the program was linked.");
+
+    messages.clear();
+    gl_layer_on_glUniform3f(0, 0.0f, 0.0f, 0.0f);
+    gl_layer_on_glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr);
+    CHECK(messages.size() == 1);
+    gl_layer_on_glUniform3fv(1, 1, value);
+    gl_layer_on_glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr);
+    gl_layer_on_glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, nullptr);
+    CHECK(messages.size() == 1);
+
+    // Changing the vertex array or relinking the program is noticed by the next draw.
+    messages.clear();
+    gl_layer_on_glBindVertexArray(0);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glDrawArrays: No vertex array object bound, this is an error in core profile contexts.");
+
+    messages.clear();
+    int status = 1;
+    gl_layer_on_glBindVertexArray(1);
+    gl_layer_on_glLinkProgram(1);
+    gl_layer_on_glGetProgramiv(1, GL_LINK_STATUS, &status);
+    gl_layer_on_glDrawArraysInstanced(GL_TRIANGLES, 0, 3, 2);
+    CHECK(messages.size() == 1);
+
+    // Uniforms written by calls that are not sampled still count.
+    messages.clear();
+    gl_layer_set_sampling(GL_LAYER_SAMPLE_CALLS, 2);
+    gl_layer_on_glUniform3f(0, 0.0f, 0.0f, 0.0f);
+    gl_layer_on_glUniform3f(1, 0.0f, 0.0f, 0.0f);
+    gl_layer_on_glDrawArraysInstanced(GL_TRIANGLES, 0, 3, 2);
+    CHECK(messages.empty());
+
+    // Deleting the bound vertex array unbinds it, deleting another one changes nothing.
+    const unsigned int arrays[2] = { 2, 1 };
+    gl_layer_set_sampling(GL_LAYER_SAMPLE_ALL, 1);
+    gl_layer_on_glDeleteVertexArrays(1, &arrays[0]);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.empty());
+    gl_layer_on_glDeleteVertexArrays(1, &arrays[1]);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.size() == 1);
+    messages.clear();
+    gl_layer_on_glBindVertexArray(1);
+
+    // A new program may get the bits of a deleted one, they start out cleared.
+    gl_layer_set_sampling(GL_LAYER_SAMPLE_ALL, 1);
+    gl_layer_on_glDeleteProgram(1);
+    gl_layer_on_glAttachShader(2, 1);
+    gl_layer_on_glLinkProgram(2);
+    gl_layer_on_glGetProgramiv(2, GL_LINK_STATUS, &status);
+    gl_layer_on_glUseProgram(2);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glDrawArrays: Uniform at location 0 of program 2 was not set since the program was linked.");
+    gl_layer_terminate();
+}
+
+// Calls that OpenGL rejects write no uniform, and arrays are only written up to their end, even while the uniform rule
+// that reports those calls is disabled.
+void test_draw_validation_uniform_writes() {
+    init_layer();
+    gl_layer_set_message_dedup(0, 0);
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL & ~GL_LAYER_RULE_UNIFORM);
+    driver.uniform_count = 5;
+    create_program();
+    gl_layer_on_glBindVertexArray(1);
+    gl_layer_on_glUseProgram(1);
+    const float values[24] = {};
+
+    gl_layer_on_glUniform3f(0, 0.0f, 0.0f, 0.0f);
+    gl_layer_on_glUniform3fv(0, 2, values);
+    gl_layer_on_glUniform1fv(1, 1, values);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glDrawArrays: Uniform at location 1 of program 1 was not set since the program was linked.");
+
+    messages.clear();
+    gl_layer_on_glUniform3fv(1, 1, values);
+    gl_layer_on_glUniform1fv(2, 8, values);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glDrawArrays: Uniform at location 7 of program 1 was not set since the program was linked.");
+    gl_layer_terminate();
+}
+
+void test_uniform_validation() {
+    init_layer();
+    gl_layer_set_message_dedup(0, 0);
+    driver.uniform_count = 4;
+    create_program();
+    gl_layer_on_glUseProgram(1);
+    const float values[4] = {};
+
+    // Booleans aside, the function has to match the type exactly. Samplers are set with glUniform1i, and array elements
+    // have locations of their own. Setting more elements than the array has left is not an error, and location -1 is
+    // ignored.
+    gl_layer_on_glUniform3f(0, 1.0f, 2.0f, 3.0f);
+    gl_layer_on_glUniform3fv(1, 1, values);
+    gl_layer_on_glUniform1i(6, 0);
+    gl_layer_on_glUniform1fv(2, 4, values);
+    gl_layer_on_glUniform1fv(4, 4, values);
+    gl_layer_on_glUniform1f(-1, 0.0f);
+    gl_layer_on_glProgramUniform3f(1, 0, 1.0f, 2.0f, 3.0f);
+    CHECK(messages.empty());
+
+    gl_layer_on_glUniform1i(0, 1);
+    gl_layer_on_glUniform3f(7, 1.0f, 2.0f, 3.0f);
+    gl_layer_on_glUniform3fv(0, 2, values);
+    gl_layer_on_glUniform1f(6, 0.0f);
+    gl_layer_on_glProgramUniform3f(5, 0, 1.0f, 2.0f, 3.0f);
+    CHECK(messages.size() == 5);
+    if (messages.size() == 5) {
+        CHECK(messages[0] == "glUniform1i(location = 0, v0 = 1): Function does not match the type of the uniform at this location.");
+        CHECK(messages[1] == "glUniform3f(location = 7, v0 = 1, v1 = 2, v2 = 3): No active uniform at this location in the program.");
+        CHECK(messages[2].find("): Count is negative, or larger than 1 for a uniform that is not an array.") != std::string::npos);
+        CHECK(messages[3] == "glUniform1f(location = 6, v0 = 0): Function does not match the type of the uniform at this location.");
+        CHECK(messages[4] == "glProgramUniform3f(program = 5, location = 0, v0 = 1, v1 = 2, v2 = 3): Invalid program handle.");
+    }
+
+    messages.clear();
+    gl_layer_on_glUseProgram(0);
+    gl_layer_on_glUniform3f(0, 1.0f, 2.0f, 3.0f);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "glUniform3f: No program bound.");
+
+    messages.clear();
+    gl_layer_set_rule_mask(GL_LAYER_RULE_ALL & ~GL_LAYER_RULE_UNIFORM);
+    gl_layer_on_glUseProgram(1);
+    gl_layer_on_glUniform1i(0, 1);
+    CHECK(messages.empty());
+    gl_layer_terminate();
+}
+
+void test_redundant_uniform_uploads() {
+    init_layer();
+    create_program();
+    gl_layer_on_glUseProgram(1);
+    const float value[3] = { 1.0f, 2.0f, 3.0f };
+
+    // The first upload to a location is never redundant, after that the values are compared.
+    gl_layer_on_glUniform3f(0, 1.0f, 2.0f, 3.0f);
+    gl_layer_on_glUniform3f(0, 1.0f, 2.0f, 3.0f);
+    gl_layer_on_glUniform3f(0, 1.0f, 2.0f, 3.0f);
+    gl_layer_on_glUniform3f(1, 1.0f, 2.0f, 3.0f);
+    gl_layer_on_glUniform3fv(1, 1, value);
+    gl_layer_on_glProgramUniform3f(1, 0, 4.0f, 5.0f, 6.0f);
+    CHECK(messages.empty());
+
+    gl_layer_end_frame();
+    GLLayerFrameStats stats{};
+    gl_layer_get_frame_stats(&stats);
+    CHECK(stats.uniform_uploads == 6);
+    CHECK(stats.redundant_uniform_uploads == 3);
+    CHECK(stats.redundant_uniform_bytes == 36);
+    CHECK(messages.size() == 1);
+    CHECK(!messages.empty() && messages[0] == "Program 1: 3 of 6 uniform upload(s) changed nothing, 36 bytes.");
+
+    messages.clear();
+    gl_layer_on_glUniform3f(0, 4.0f, 5.0f, 6.0f);
+    gl_layer_end_frame();
+    gl_layer_get_frame_stats(&stats);
+    CHECK(stats.uniform_uploads == 1);
+    CHECK(stats.redundant_uniform_uploads == 1);
+    CHECK(messages.size() == 1);
+
+    // Linking resets the uniforms, so does it for their copies.
+    messages.clear();
+    int status = 1;
+    gl_layer_on_glLinkProgram(1);
+    gl_layer_on_glGetProgramiv(1, GL_LINK_STATUS, &status);
+    gl_layer_on_glUniform3f(0, 4.0f, 5.0f, 6.0f);
+    gl_layer_end_frame();
+    gl_layer_get_frame_stats(&stats);
+    CHECK(stats.uniform_uploads == 1);
+    CHECK(stats.redundant_uniform_uploads == 0);
+    CHECK(messages.empty());
+    gl_layer_terminate();
+}
+
+std::vector<gl_layer::TraceRecord> read_trace(const gl_layer::TraceReader& reader) {
+    std::vector<gl_layer::TraceRecord> records;
+    CHECK(reader.for_each([&records](const gl_layer::TraceRecord& record) { records.push_back(record); }));
+    return records;
+}
+
+float float_arg(std::uint64_t arg) {
+    auto bits = static_cast<std::uint32_t>(arg);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void test_trace_recording() {
+    const char* path = "gl_layer_test_trace.bin";
+    init_layer();
+    CHECK(gl_layer_start_trace(path, 0) == 0);
+
+    create_program();
+    gl_layer_on_glUseProgram(1);
+    gl_layer_on_glUniform3f(1, 0.5f, -1.0f, 2.0f);
+    gl_layer_end_frame();
+
+    // Calls are recorded even while no rule needs them, functions the layer does not validate are not.
+    gl_layer_set_rule_mask(GL_LAYER_RULE_NONE);
+    const unsigned int textures[3] = { 4, 5, 6 };
+    gl_layer_on_glDeleteTextures(3, textures);
+    gl_layer_callback("glClear", nullptr, 1, 0x4000u);
+    gl_layer_stop_trace();
+    gl_layer_on_glUseProgram(0);
+    gl_layer_terminate();
+
+    gl_layer::TraceReader reader;
+    CHECK(reader.open(path));
+    std::vector<gl_layer::TraceRecord> records = read_trace(reader);
+    CHECK(records.size() == 10);
+    if (records.size() == 10) {
+        using gl_layer::EntryPoint;
+        CHECK(records[0].entry_point == EntryPoint::glCompileShader && records[0].args[0] == 1);
+        CHECK(records[1].entry_point == EntryPoint::glGetShaderiv && records[1].args[1] == GL_COMPILE_STATUS);
+        CHECK(records[1].array_bytes == 4 && records[1].array[0] == 1);
+        CHECK(records[2].entry_point == EntryPoint::glAttachShader);
+        CHECK(records[3].entry_point == EntryPoint::glLinkProgram);
+        CHECK(records[4].entry_point == EntryPoint::glGetProgramiv && records[4].args[1] == GL_LINK_STATUS);
+        CHECK(records[5].entry_point == EntryPoint::glUseProgram && records[5].args[0] == 1);
+        // The first use reflects the program, the results follow the call.
+        CHECK(records[6].tag == static_cast<std::uint8_t>(gl_layer::TraceTag::ProgramUniforms) && records[6].args[0] == 1);
+        CHECK(records[6].array_bytes == 2 * sizeof(gl_layer::TraceUniform));
+        CHECK(records[7].entry_point == EntryPoint::glUniform3f && records[7].args[0] == 1);
+        CHECK(float_arg(records[7].args[1]) == 0.5f && float_arg(records[7].args[2]) == -1.0f && float_arg(records[7].args[3]) == 2.0f);
+        CHECK(records[8].tag == static_cast<std::uint8_t>(gl_layer::TraceTag::EndFrame));
+        CHECK(records[9].entry_point == EntryPoint::glDeleteTextures && records[9].args[0] == 3);
+        CHECK(records[9].array_bytes == sizeof(textures) && std::memcmp(records[9].array, textures, sizeof(textures)) == 0);
+    }
+    CHECK(reader.gl_version().major == 3 && reader.gl_version().minor == 3 && !reader.wrapped());
+    std::remove(path);
+}
+
+// Once the file is full the oldest calls are overwritten. The file can be read while recording, like after a crash, and
+// holds every call up to the last one.
+void test_trace_ring_buffer() {
+    const char* path = "gl_layer_test_trace_ring.bin";
+    init_layer();
+    gl_layer_set_rule_mask(GL_LAYER_RULE_NONE);
+    CHECK(gl_layer_start_trace(path, 0) == 0);
+
+    constexpr unsigned int call_count = 200'000;
+    std::size_t allocations = allocation_count;
+    for (unsigned int i = 1; i <= call_count; ++i) {
+        gl_layer_on_glBindTexture(GL_TEXTURE_2D, i);
+    }
+    CHECK(allocation_count == allocations);
+
+    gl_layer::TraceReader reader;
+    CHECK(reader.open(path));
+    std::vector<gl_layer::TraceRecord> records = read_trace(reader);
+    CHECK(!records.empty() && records.size() < call_count);
+    bool consecutive = true;
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        consecutive &= records[i].entry_point == gl_layer::EntryPoint::glBindTexture && records[i].args[0] == GL_TEXTURE_2D &&
+                       records[i].args[1] == call_count - records.size() + 1 + i;
+    }
+    CHECK(consecutive);
+
+    gl_layer_terminate();
+    std::remove(path);
+}
+
+// Replaying a trace into a context without a driver reports what the recording did, using the recorded reflection.
+void test_trace_replay() {
+    const char* path = "gl_layer_test_trace_replay.bin";
+    init_layer();
+    gl_layer_set_message_dedup(0, 0);
+    records.clear();
+    gl_layer_set_message_callback(&record_message, nullptr);
+    driver.uniform_count = 4;
+    CHECK(gl_layer_start_trace(path, 0) == 0);
+
+    const float values[6] = {};
+    create_program();
+    gl_layer_on_glUseProgram(1);
+    gl_layer_on_glUniform1fv(2, 4, values);
+    gl_layer_on_glUniform1i(0, 1);
+    gl_layer_on_glUniform3fv(0, 2, values);
+    gl_layer_end_frame();
+
+    // After the relink the program has fewer uniforms, the replay has to tell the two reflections apart.
+    int status = 1;
+    driver.uniform_count = 2;
+    gl_layer_on_glLinkProgram(1);
+    gl_layer_on_glGetProgramiv(1, GL_LINK_STATUS, &status);
+    gl_layer_on_glUseProgram(1);
+    gl_layer_on_glUniform1fv(2, 4, values);
+    gl_layer_on_glDrawArrays(GL_TRIANGLES, 0, 3);
+    gl_layer_end_frame();
+    gl_layer_terminate();
+
+    std::vector<GLLayerMessage> recorded = records;
+    CHECK(recorded.size() == 6);
+
+    gl_layer::TraceReader reader;
+    CHECK(reader.open(path));
+    gl_layer::TraceReplay replay(reader);
+    {
+        gl_layer::Context context(reader.gl_version(), &gl_layer::TraceReplay::gl_functions());
+        context.set_message_callback(&record_message, nullptr);
+        context.set_message_dedup(false, std::chrono::milliseconds(0));
+        driver.reset();
+        records.clear();
+        CHECK(replay.run(context));
+    }
+    CHECK(driver.queries == 0);
+    // Pointers in the replay point to copies of the recorded arrays, so only the arguments differ.
+    bool same = records.size() == recorded.size();
+    for (std::size_t i = 0; same && i < records.size(); ++i) {
+        same = records[i].id == recorded[i].id && records[i].entry_point == recorded[i].entry_point &&
+               records[i].handle_count == recorded[i].handle_count && records[i].handles[0] == recorded[i].handles[0];
+    }
+    CHECK(same);
+    CHECK(replay.stats().calls == 14);
+    CHECK(replay.stats().frames == 2);
+    CHECK(replay.stats().skipped_calls == 0);
+    CHECK(replay.stats().missing_reflections == 0);
+    std::remove(path);
+}
+}
+
+int main() {
+    test_link_issues_no_queries();
+    test_reflection_on_first_use();
+    test_no_reflection_for_unchecked_program();
+    test_parallel_compile();
+    test_async_output();
+    test_message_dedup();
+    test_output_does_not_allocate();
+    test_structured_messages();
+    test_rule_mask();
+    test_multiple_contexts();
+    test_concurrent_share_group();
+    test_sampling();
+    test_redundant_program_binds();
+    test_redundant_state_changes();
+    test_draw_validation();
+    test_draw_validation_uniform_writes();
+    test_uniform_validation();
+    test_redundant_uniform_uploads();
+    test_trace_recording();
+    test_trace_ring_buffer();
+    test_trace_replay();
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <gl_layer/private/replay.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct MessageCounts {
+    std::uint64_t severities[3] = {};
+};
+
+void print_message(const GLLayerMessage* message, void* user_data) {
+    char text[1024];
+    gl_layer_format_message(message, text, sizeof(text));
+    std::printf("%s\n", text);
+    ++static_cast<MessageCounts*>(user_data)->severities[message->severity];
+}
+
+int usage(const char* program) {
+    std::fprintf(stderr, "usage: %s [--rules <mask|names>] <trace>\n", program);
+    return 1;
+}
+
+}
+
+// Replays a trace into a fresh context and prints the messages it reports. Exits with 2 if there were errors.
+int main(int argc, char** argv) {
+    const char* rules = nullptr;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--rules") == 0 && i + 1 < argc) {
+            rules = argv[++i];
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (!path) return usage(argv[0]);
+
+    gl_layer::TraceReader reader;
+    if (!reader.open(path)) {
+        std::fprintf(stderr, "%s is not a trace, or was recorded by another version\n", path);
+        return 1;
+    }
+
+    gl_layer::TraceReplay replay(reader);
+    gl_layer::Context context(reader.gl_version(), &gl_layer::TraceReplay::gl_functions());
+    MessageCounts counts;
+    context.set_message_callback(&print_message, &counts);
+    if (rules) context.set_rule_mask(gl_layer::parse_rule_mask(rules));
+
+    auto start = std::chrono::steady_clock::now();
+    bool complete = replay.run(context);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const gl_layer::TraceReplay::Stats& stats = replay.stats();
+    std::printf("\n%llu calls in %llu frames replayed in %.3f s (%.1f M calls/s)\n", static_cast<unsigned long long>(stats.calls),
+                static_cast<unsigned long long>(stats.frames), seconds, seconds > 0 ? stats.calls / seconds / 1e6 : 0.0);
+    std::printf("%llu errors, %llu warnings\n", static_cast<unsigned long long>(counts.severities[GL_LAYER_SEVERITY_ERROR]),
+                static_cast<unsigned long long>(counts.severities[GL_LAYER_SEVERITY_WARNING]));
+    if (stats.skipped_calls > 0) {
+        std::printf("%llu calls skipped, their arrays were too large to record\n", static_cast<unsigned long long>(stats.skipped_calls));
+    }
+    if (stats.missing_reflections > 0) {
+        std::printf("%llu programs reflected without recorded uniforms, their uniform checks may be wrong\n",
+                    static_cast<unsigned long long>(stats.missing_reflections));
+    }
+    if (reader.wrapped()) std::printf("The trace wrapped around, it starts in the middle of the recording\n");
+    if (!complete) std::printf("The trace ends in a damaged record\n");
+
+    return counts.severities[GL_LAYER_SEVERITY_ERROR] > 0 ? 2 : 0;
+}